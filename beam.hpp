@@ -0,0 +1,287 @@
+#pragma once
+#include "block.hpp"
+#include "hash.hpp"
+#include "successor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// search over a queue of pieces: after every placement only the width best boards are kept (beam search).
+// each layer is expanded by all threads at once, a thread that runs out of parents steals half of the
+// parents another thread has left; children go through one shared transposition table and live in
+// per-thread arenas until the search returns.
+namespace reachability::inline REACHABILITY_ISA::search {
+  // objects that live as long as the arena, handed out from chunks that never move
+  template <typename T, std::size_t chunk_size=4096>
+  class arena {
+  public:
+    T *make(const T &value) {
+      if (used == chunk_size) [[unlikely]] {
+        chunks.push_back(std::make_unique<T[]>(chunk_size));
+        used = 0;
+      }
+      T *ret = &chunks.back()[used++];
+      *ret = value;
+      return ret;
+    }
+    std::size_t size() const {
+      return chunks.size() * chunk_size - (chunk_size - used);
+    }
+  private:
+    std::vector<std::unique_ptr<T[]>> chunks;
+    std::size_t used = chunk_size;
+  };
+
+  // set of 64-bit keys shared by every thread, open addressing with linear probing;
+  // a key that finds no slot within a few probes is let through, a missed duplicate only costs time
+  class transposition_table {
+  public:
+    explicit transposition_table(int bits): mask((std::size_t(1) << bits) - 1), slots(std::make_unique<std::atomic<std::uint64_t>[]>(mask + 1)) {}
+    // true if key was not in the table yet
+    bool insert(std::uint64_t key) {
+      key |= 1; // 0 is an empty slot
+      for (std::size_t i = key, probes = 0; probes < 16; ++i, ++probes) {
+        auto &slot = slots[i & mask];
+        std::uint64_t seen = slot.load(std::memory_order_relaxed);
+        if (seen == 0 && slot.compare_exchange_strong(seen, key, std::memory_order_relaxed)) {
+          return true;
+        }
+        if (seen == key) {
+          return false;
+        }
+      }
+      return true;
+    }
+    bool contains(std::uint64_t key) const {
+      key |= 1;
+      for (std::size_t i = key, probes = 0; probes < 16; ++i, ++probes) {
+        const std::uint64_t seen = slots[i & mask].load(std::memory_order_relaxed);
+        if (seen == key) {
+          return true;
+        }
+        if (seen == 0) {
+          return false;
+        }
+      }
+      return false;
+    }
+  private:
+    std::size_t mask;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+  };
+
+  namespace details {
+    // the tasks [begin, end) of one thread packed in one word, the owner takes them from the front
+    // and a thief takes the back half, both with a single compare and swap
+    class alignas(64) task_range {
+    public:
+      void reset(std::uint32_t begin, std::uint32_t end) {
+        range.store(begin | std::uint64_t(end) << 32, std::memory_order_relaxed);
+      }
+      bool pop(std::uint32_t &task) {
+        std::uint64_t r = range.load(std::memory_order_relaxed);
+        while (std::uint32_t(r) < std::uint32_t(r >> 32)) {
+          if (range.compare_exchange_weak(r, r + 1, std::memory_order_acq_rel)) {
+            task = std::uint32_t(r);
+            return true;
+          }
+        }
+        return false;
+      }
+      // thief must be empty and owned by the caller
+      bool steal_into(task_range &thief) {
+        std::uint64_t r = range.load(std::memory_order_relaxed);
+        while (true) {
+          const std::uint32_t begin = r, end = r >> 32;
+          if (begin >= end) {
+            return false;
+          }
+          const std::uint32_t mid = begin + (end - begin) / 2;
+          if (range.compare_exchange_weak(r, begin | std::uint64_t(mid) << 32, std::memory_order_acq_rel)) {
+            thief.reset(mid, end);
+            return true;
+          }
+        }
+      }
+    private:
+      std::atomic<std::uint64_t> range = 0;
+    };
+  }
+
+  template <typename board_t>
+  struct beam_node {
+    board_t board;
+    const beam_node *parent; // nullptr at the root
+    std::uint64_t hash;      // of board
+    double score;            // what the evaluation gave, the root has 0
+    std::size_t next;        // pieces of the queue used so far, placed or held
+    std::optional<block_type> hold;
+    // the placement leading here
+    block_type piece;
+    std::uint8_t shape;
+    std::int8_t x, y;
+    std::uint8_t lines;
+  };
+
+  template <typename board_t>
+  struct placement {
+    board_t board; // after lock and line clear
+    block_type piece;
+    std::uint8_t shape;
+    std::int8_t x, y;
+    std::uint8_t lines;
+  };
+
+  struct beam_options {
+    std::size_t width = 1000; // nodes kept after every placement
+    std::size_t depth = 0;    // placements to search, 0 for as many as the queue allows
+    unsigned threads = 1;
+    int table_bits = 20;      // the transposition table holds 2^table_bits states
+    bool use_hold = true;
+  };
+
+  template <typename board_t>
+  struct beam_result {
+    std::vector<placement<board_t>> moves; // the best line found, empty if nothing can be placed
+    double score;
+    std::size_t nodes;      // successors generated, including duplicates
+    std::size_t duplicates; // successors dropped by the transposition table
+  };
+
+  // beam search from board with the pieces of queue still to come and hold held (if any).
+  // evaluate(const beam_node<board_t> &) gives the score of a new node, higher is better; its parent is already
+  // scored, so running totals can be kept. it is called from every thread at once.
+  // states are told apart by board hash, hold and the position in the queue only
+  template <typename RS, coord start, typename board_t, typename F>
+  beam_result<board_t> beam_search(board_t board, std::span<const block_type> queue, std::optional<block_type> hold, F evaluate, beam_options options = {}) {
+    using node = beam_node<board_t>;
+    struct alignas(64) worker {
+      arena<node> nodes;
+      std::vector<const node *> children;
+      std::vector<successor<board_t>> successors = std::vector<successor<board_t>>(4 * board_t::width * board_t::height);
+      std::size_t generated = 0, duplicates = 0;
+    };
+    const unsigned threads = std::max(options.threads, 1u);
+    const std::size_t depth = options.depth ? options.depth : queue.size();
+    std::vector<worker> workers(threads);
+    std::vector<details::task_range> ranges(threads);
+    transposition_table table(options.table_bits);
+    const node root{board, nullptr, hash_of(board), 0, 0, hold, {}, 0, 0, 0, 0};
+    std::vector<const node *> beam = {&root};
+    std::size_t layer = 0;
+    bool finished = depth == 0;
+    const auto distribute = [&] {
+      for (unsigned t = 0; t < threads; ++t) {
+        ranges[t].reset(beam.size() * t / threads, beam.size() * (t + 1) / threads);
+      }
+    };
+    const auto expand = [&](worker &w, const node &parent) {
+      const auto place = [&](block_type piece, std::optional<block_type> new_hold, std::size_t next) {
+        const std::size_t n = generate_successors<RS, start>(parent.board, piece, std::span{w.successors});
+        const std::uint64_t state = reachability::details::mix(next << 3 | (new_hold ? std::size_t(*new_hold) + 1 : 0));
+        for (std::size_t i = 0; i < n; ++i) {
+          const auto &s = w.successors[i];
+          const std::uint64_t hash = hash_of(s.board);
+          if (!table.insert(hash ^ state)) {
+            ++w.duplicates;
+            continue;
+          }
+          node child{s.board, &parent, hash, 0, next, new_hold, piece, s.shape, s.x, s.y, s.lines};
+          child.score = evaluate(std::as_const(child));
+          w.children.push_back(w.nodes.make(child));
+        }
+        w.generated += n;
+      };
+      const std::size_t next = parent.next;
+      if (next >= queue.size()) {
+        // out of pieces, the node stays in the beam as it is
+        w.children.push_back(&parent);
+        return;
+      }
+      place(queue[next], parent.hold, next + 1);
+      if (!options.use_hold) {
+        return;
+      }
+      if (parent.hold) {
+        if (*parent.hold != queue[next]) {
+          place(*parent.hold, queue[next], next + 1);
+        }
+      } else if (next + 1 < queue.size()) {
+        place(queue[next + 1], queue[next], next + 2);
+      }
+    };
+    // runs once all threads are done with a layer
+    const auto select = [&]() noexcept {
+      std::size_t total = 0;
+      for (const auto &w : workers) {
+        total += w.children.size();
+      }
+      ++layer;
+      finished = total == 0 || layer == depth;
+      if (total == 0) {
+        return;
+      }
+      beam.clear();
+      for (auto &w : workers) {
+        beam.insert(beam.end(), w.children.begin(), w.children.end());
+        w.children.clear();
+      }
+      if (beam.size() > options.width) {
+        std::nth_element(beam.begin(), beam.begin() + options.width, beam.end(), [](const node *a, const node *b) {
+          return a->score > b->score;
+        });
+        beam.resize(options.width);
+      }
+      distribute();
+    };
+    std::barrier sync(threads, select);
+    const auto work = [&](unsigned id) {
+      while (!finished) {
+        std::uint32_t task;
+        while (true) {
+          if (!ranges[id].pop(task)) {
+            bool stolen = false;
+            for (unsigned k = 1; k < threads && !stolen; ++k) {
+              stolen = ranges[(id + k) % threads].steal_into(ranges[id]);
+            }
+            if (!stolen) {
+              break;
+            }
+            continue;
+          }
+          expand(workers[id], *beam[task]);
+        }
+        sync.arrive_and_wait();
+      }
+    };
+    distribute();
+    {
+      std::vector<std::jthread> pool;
+      for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(work, t);
+      }
+      work(0);
+    }
+    beam_result<board_t> ret{{}, 0, 0, 0};
+    for (const auto &w : workers) {
+      ret.nodes += w.generated;
+      ret.duplicates += w.duplicates;
+    }
+    const node *best = *std::max_element(beam.begin(), beam.end(), [](const node *a, const node *b) {
+      return a->score < b->score;
+    });
+    ret.score = best->score;
+    for (const node *n = best; n->parent; n = n->parent) {
+      ret.moves.push_back({n->board, n->piece, n->shape, n->x, n->y, n->lines});
+    }
+    std::reverse(ret.moves.begin(), ret.moves.end());
+    return ret;
+  }
+}
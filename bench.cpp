@@ -1,5 +1,14 @@
 #include "block.hpp"
 #include "search.hpp"
+#include "rules.hpp"
+#include "registry.hpp"
+#include "beam.hpp"
+#include "pool.hpp"
+#include "pc.hpp"
+#include "cache.hpp"
+#include "successor.hpp"
+#include "generator.hpp"
+#include "dispatch.hpp"
 #include <string_view>
 #include <cstdio>
 #include <cmath>
@@ -7,26 +16,513 @@
 using namespace std;
 
 template <bool print=false, reachability::coord start=reachability::coord{4, 20}, unsigned init_rot=0>
-double test(const BOARD &b, string_view name, reachability::block_type block) {
+array<double, 4> test(const BOARD &b, string_view name, reachability::block_type block) {
   using namespace reachability::search;
   using namespace reachability::blocks;
   printf("BOARD %s\n", name.data());
   printf(" BLOCK %c\n", name_of(block));
-  auto binary_time = bench<100000000>([](BOARD b, reachability::block_type block){ return binary_bfs<SRS, start, init_rot>(b, block); }, b, block);
+  const bench_scope board_scope{string(name)}, block_scope{string(1, name_of(block))};
+  auto binary_time = bench<100000000>("binary", [](BOARD b, reachability::block_type block){ return binary_bfs<SRS, start, init_rot>(b, block); }, b, block);
   printf("  binary  : %f cycles\n", binary_time);
-  return binary_time;
+  auto column_time = bench<100000000>("column", [](COLUMN_BOARD b, reachability::block_type block){ return binary_bfs<SRS, start, init_rot>(b, block); }, COLUMN_BOARD{b}, block);
+  printf("  column  : %f cycles\n", column_time);
+  auto hard_time = bench<100000000>("hard", [](BOARD b, reachability::block_type block){ return binary_bfs<SRS, start, init_rot, movement::hard_drop>(b, block); }, b, block);
+  printf("  hard    : %f cycles\n", hard_time);
+  using reachability::operator""_szc;
+  using spawns = spawn_range<start[0_szc], start[0_szc], start[1_szc], start[1_szc]>;
+  auto runtime_time = bench<100000000>("runtime", [](BOARD b, reachability::block_type block){ return binary_bfs<SRS, spawns>(b, block, start, init_rot); }, b, block);
+  printf("  runtime : %f cycles\n", runtime_time);
+  return {binary_time, column_time, hard_time, runtime_time};
 }
-int main() {
-  double binary_sum = 0;
+template <reachability::search::closure kind>
+array<double, 2> test_closure(const BOARD &b) {
+  using namespace reachability::search;
+  using namespace reachability::blocks;
+  BOARD usable[SRS::T.shapes];
+  reachability::static_for<SRS::T.shapes>([&](auto i) {
+    usable[i] = usable_positions<SRS::T.minos[i]>(b);
+  });
+  array<BOARD, SRS::T.orientations> cache;
+  int steps = 0;
+  soft_drop_closure<SRS::T, reachability::coord{4, 20}, 0, kind>(usable, cache, &steps);
+  auto closure_time = bench<100000000>(kind == closure::step ? "step" : "log_step", [](BOARD b){ return binary_bfs<SRS::T, reachability::coord{4, 20}, 0, movement::soft_drop, kind>(b); }, b);
+  return {double(steps), closure_time};
+}
+double test_pieces(const BOARD &b, string_view name) {
+  using namespace reachability::search;
+  using namespace reachability::blocks;
+  using enum reachability::block_type;
+  static constexpr reachability::block_type all[] = {T, Z, S, J, L, O, I};
+  printf("BOARD %s\n", name.data());
+  const bench_scope scope{string(name)};
+  auto pieces_time = bench<100000000 / 7>("pieces", [](BOARD b){ return binary_bfs_pieces<SRS, reachability::coord{4, 20}>(b, all); }, b);
+  printf("  pieces  : %f cycles for all 7\n", pieces_time);
+  return pieces_time;
+}
+// every placement of all 7 pieces locked and cleared, the reachability search included
+double test_successors(const BOARD &b, string_view name) {
+  using namespace reachability::search;
+  static vector<successor<BOARD>> out(4 * BOARD::width * BOARD::height);
+  printf("BOARD %s\n", name.data());
+  const bench_scope scope{string(name)};
+  auto successors_time = bench<100000000 / 7>("lock", [](BOARD b){
+    size_t n = 0;
+    for (int piece = 0; piece < 7; ++piece) {
+      n += generate_successors<reachability::blocks::SRS, reachability::coord{4, 20}>(b, reachability::block_type(piece), span{out});
+    }
+    return n;
+  }, b);
+  printf("  lock    : %f cycles for all 7\n", successors_time);
+  return successors_time;
+}
+array<double, 2> test_rules(const BOARD &b, string_view name, reachability::block_type block) {
+  using namespace reachability::search;
+  using namespace reachability::blocks;
+  // the same SRS table, once matched to the compiled kernels and once interpreted
+  static const auto rules = parse_rotation_system(to_text(to_runtime<SRS>()));
+  static const rule_engine<reachability::coord{4, 20}, BOARD, SRS, SRS_plus> engine(rules);
+  printf("BOARD %s\n", name.data());
+  printf(" BLOCK %c\n", name_of(block));
+  const bench_scope board_scope{string(name)}, block_scope{string(1, name_of(block))};
+  auto compiled_time = bench<100000000>("compiled", [](BOARD b, reachability::block_type block){ return engine(b, block); }, b, block);
+  printf("  compiled: %f cycles\n", compiled_time);
+  auto interp_time = bench<100000000 / 4>("interp", [](BOARD b, reachability::block_type block){ return binary_bfs_interpreted(b, rules[size_t(block)], reachability::coord{4, 20}, 0); }, b, block);
+  printf("  interp  : %f cycles\n", interp_time);
+  return {compiled_time, interp_time};
+}
+double test_geometry(const BOARD &b, string_view name, const reachability::geometry_handle &geometry) {
+  using enum reachability::block_type;
+  // the bench boards are at most 12 rows, so they fit every registered height
+  array<uint64_t, 64> rows = {};
+  reachability::details::to_rows(b, std::span{rows});
+  printf("BOARD %s\n", name.data());
+  const bench_scope scope{string(name)};
+  auto geometry_time = bench<100000000 / 7>(to_string(geometry.width) + "x" + to_string(geometry.height), [&](span<const uint64_t> rows) {
+    array<uint64_t, 4 * 64> out;
+    int shapes = 0;
+    for (auto block : {T, Z, S, J, L, O, I}) {
+      shapes += geometry.binary_bfs(rows, block, reachability::coord{4, geometry.height - 4}, 0, out);
+    }
+    return shapes;
+  }, span<const uint64_t>{rows.data(), size_t(geometry.height)}) / 7;
+  printf("  %dx%d  : %f cycles (%d words)\n", geometry.width, geometry.height, geometry_time, geometry.num_of_under);
+  return geometry_time;
+}
+double test_batch(const BATCH &b, reachability::block_type block) {
+  using namespace reachability::search;
+  using namespace reachability::blocks;
+  printf("BATCH OF %zu BOARDS\n", LANES);
+  printf(" BLOCK %c\n", name_of(block));
+  const bench_scope batch_scope{"BATCH"}, block_scope{string(1, name_of(block))};
+  auto batch_time = bench<100000000 / LANES>("batch", [](BATCH b, reachability::block_type block){ return binary_bfs_batch<SRS, reachability::coord{4, 20}, 0>(b, block); }, b, block) / LANES;
+  printf("  batch   : %f cycles per board\n", batch_time);
+  return batch_time;
+}
+// nodes per second of an 8-piece beam search with 1, 2, 4, ... threads, up to the number of cores
+void test_beam(const BOARD &b, string_view name) {
+  using namespace reachability::search;
+  using enum reachability::block_type;
+  static constexpr reachability::block_type queue[] = {T, I, L, O, S, J, Z, T};
+  printf("BOARD %s\n", name.data());
+  const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned threads = 1;; threads = std::min(threads * 2, cores)) {
+    const auto start = chrono::steady_clock::now();
+    const auto result = beam_search<reachability::blocks::SRS, reachability::coord{4, 20}>(b, queue, std::nullopt, [](const beam_node<BOARD> &node) {
+      return node.parent->score + node.lines * node.lines - node.y;
+    }, {.width = 200, .threads = threads});
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    printf("  beam %2u : %f nodes/s (%zu nodes, %zu duplicates)\n", threads, result.nodes / seconds.count(), result.nodes, result.duplicates);
+    if (threads == cores) {
+      break;
+    }
+  }
+}
+// boards per second of binary_bfs_jobs over every board and piece, with 1, 2, 4, ... threads up to the number of cores
+void test_throughput() {
+  using namespace reachability::search;
+  using enum reachability::block_type;
+  vector<reach_job<BOARD>> jobs;
+  for (size_t n = 0; n < 100000 / board_names.size() / 7; ++n) {
+    for (const auto &b : boards) {
+      for (auto block : {T, Z, S, J, L, O, I}) {
+        jobs.push_back({b, block});
+      }
+    }
+  }
+  vector<reachability::static_vector<BOARD, 4>> out(jobs.size(), span<BOARD>{});
+  const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned threads = 1;; threads = std::min(threads * 2, cores)) {
+    reachability::thread_pool pool(threads);
+    const auto start = chrono::steady_clock::now();
+    binary_bfs_jobs<reachability::blocks::SRS, reachability::coord{4, 20}>(pool, span<const reach_job<BOARD>>{jobs}, span{out});
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    printf("  pool %2u : %f boards/s\n", threads, jobs.size() / seconds.count());
+    if (threads == cores) {
+      break;
+    }
+  }
+}
+// every perfect clear of a few standard setups on all cores: the first from an empty board with 11 pieces, and 2 rows
+void test_pc() {
+  using namespace reachability::search;
+  using enum reachability::block_type;
+  struct setup {
+    string_view name;
+    vector<reachability::block_type> queue;
+    int height;
+  };
+  const setup setups[] = {
+    {"PC IJLOSZT IJLO", {I, J, L, O, S, Z, T, I, J, L, O}, 4},
+    {"PC TSZLJOI TSZL", {T, S, Z, L, J, O, I, T, S, Z, L}, 4},
+    {"PC OLIZTJS OLIZ", {O, L, I, Z, T, J, S, O, L, I, Z}, 4},
+    {"PC 2 ROWS IOLJIO", {I, O, L, J, I, O}, 2}
+  };
+  reachability::thread_pool pool;
+  for (const auto &s : setups) {
+    printf("SETUP %s\n", s.name.data());
+    const auto start = chrono::steady_clock::now();
+    const auto result = perfect_clear<reachability::blocks::SRS, reachability::coord{4, 20}>(pool, BOARD(), s.queue, std::nullopt, {.height = s.height});
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    printf("  pc      : %f solutions/s (%zu solutions, %zu boards)\n", result.solutions.size() / seconds.count(), result.solutions.size(), result.nodes);
+    printf("  first   : %f us\n", result.first_solution * 1e6);
+  }
+}
+// the (board, piece) calls of an exhaustive 3-piece search with hold from b, as a trace for the cache
+vector<reachability::search::reach_job<BOARD>> search_trace(const BOARD &b) {
+  using namespace reachability::search;
+  using enum reachability::block_type;
+  static constexpr reachability::block_type queue[] = {T, I, L, O};
+  vector<reach_job<BOARD>> trace;
+  vector<successor<BOARD>> out(4 * WIDTH * HEIGHT);
+  const auto visit = [&](auto &self, BOARD board, size_t next, optional<reachability::block_type> hold, int depth) -> void {
+    if (depth == 3 || next >= std::size(queue)) {
+      return;
+    }
+    const auto place = [&](reachability::block_type piece, optional<reachability::block_type> new_hold, size_t new_next) {
+      trace.push_back({board, piece});
+      const size_t n = generate_successors<reachability::blocks::SRS, reachability::coord{4, 20}>(board, piece, span{out});
+      const vector<successor<BOARD>> children(out.begin(), out.begin() + n);
+      for (const auto &child : children) {
+        self(self, child.board, new_next, new_hold, depth + 1);
+      }
+    };
+    place(queue[next], hold, next + 1);
+    if (hold) {
+      place(*hold, queue[next], next + 1);
+    } else if (next + 1 < std::size(queue)) {
+      place(queue[next + 1], queue[next], next + 2);
+    }
+  };
+  visit(visit, b, 0, std::nullopt, 0);
+  return trace;
+}
+// nanoseconds per call of the trace, uncached and through reach_cache with both eviction policies
+void test_cache(const BOARD &b, string_view name) {
+  using namespace reachability::search;
+  using cache_t = reach_cache<reachability::blocks::SRS, reachability::coord{4, 20}, BOARD>;
+  const auto trace = search_trace(b);
+  printf("BOARD %s\n", name.data());
+  printf(" TRACE %zu calls\n", trace.size());
+  const auto replay = [&](auto &&call) {
+    const auto start = chrono::steady_clock::now();
+    for (const auto &job : trace) {
+      auto result = call(job.board, job.piece);
+      DoNotOptimize(result);
+    }
+    const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / trace.size();
+  };
+  printf("  uncached: %f ns\n", replay([](BOARD board, reachability::block_type piece) {
+    return binary_bfs<reachability::blocks::SRS, reachability::coord{4, 20}>(board, piece);
+  }));
+  for (auto [policy, policy_name] : {pair{eviction::lru, "lru "}, pair{eviction::fifo, "fifo"}}) {
+    for (size_t capacity : {size_t(1) << 10, size_t(1) << 16}) {
+      cache_t cache(capacity, policy);
+      const double time = replay([&](BOARD board, reachability::block_type piece) {
+        return cache.binary_bfs(board, piece);
+      });
+      const auto stats = cache.stats();
+      printf("  %s %5zu: %f ns (%.1f%% hits, %llu evictions)\n", policy_name, capacity, time,
+        100.0 * stats.hits / (stats.hits + stats.misses), (unsigned long long)stats.evictions);
+    }
+  }
+}
+// a 10x40 board with a stack of the given height, binary_bfs (which runs on a window of the lowest words when the
+// board takes more than one register) against the closure over the whole board
+double test_window(int stack) {
+  using namespace reachability::search;
+  using TALL = reachability::board_t<WIDTH, 40>;
+  static constexpr auto T = reachability::blocks::SRS::T;
+  TALL b;
+  for (int y = 0; y < stack; ++y) {
+    for (int x = 0; x < WIDTH; ++x) {
+      if (x != y * 3 % WIDTH) {
+        b.set(x, y);
+      }
+    }
+  }
+  printf("STACK %d OF 40\n", stack);
+  const bench_scope scope{"STACK " + to_string(stack)};
+  auto window_time = bench<100000000>("window", [](TALL b){ return binary_bfs<T, reachability::coord{4, 36}, 0>(b); }, b);
+  printf("  window  : %f cycles\n", window_time);
+  auto full_time = bench<100000000>("full", [](TALL b){
+    TALL usable[T.shapes];
+    reachability::static_for<T.shapes>([&](auto i) {
+      usable[i] = usable_positions<T.minos[i]>(b);
+    });
+    return binary_bfs_usable<T, reachability::coord{4, 36}, 0>(usable);
+  }, b);
+  printf("  full    : %f cycles\n", full_time);
+  return window_time / full_time;
+}
+// binary_bfs over boards generated like play, one class at a time, each board with a random piece
+double test_class(reachability::corpus::board_class kind) {
+  using namespace reachability::search;
+  using namespace reachability::blocks;
+  using namespace reachability::corpus;
+  constexpr reachability::coord start{4, 20};
+  generator<SRS, start, BOARD> g(kind, 1);
+  vector<board_record<BOARD>> records(4096);
+  for (auto &record : records) {
+    record = g.next_record();
+  }
+  printf("CLASS %s\n", string(name_of(kind)).c_str());
+  const bench_scope scope{"CLASS " + string(name_of(kind))};
+  size_t next = 0;
+  auto class_time = bench<10000000>("binary", [&]{
+    const auto &record = records[next++ % records.size()];
+    return binary_bfs<SRS, start>(record.board(), reachability::block_type(record.piece));
+  });
+  printf("  binary  : %f cycles\n", class_time);
+  constexpr int passes = 100;
+  const auto begin = chrono::steady_clock::now();
+  for (int _ = 0; _ < passes; ++_) {
+    for (const auto &record : records) {
+      DoNotOptimize(binary_bfs<SRS, start>(record.board(), reachability::block_type(record.piece)));
+    }
+  }
+  const chrono::duration<double> seconds = chrono::steady_clock::now() - begin;
+  printf("  binary  : %f boards/s\n", passes * records.size() / seconds.count());
+  return class_time;
+}
+// the boards of every class through the 10x24 kernel of every level this cpu runs (see dispatch.hpp), so the levels
+// are timed on the same corpus; returns 2 if no level is linked in
+int test_isa() {
+  using namespace reachability::corpus;
+  using reachability::operator""_szc;
+  namespace dispatch = reachability::dispatch;
+  constexpr reachability::coord start{4, 20};
+  const auto found = dispatch::available();
+  if (found.size() == 0) {
+    fprintf(stderr, "no kernels for this cpu are linked in, build with the objects of isa/kernels.cpp (make isa)\n");
+    return 2;
+  }
+  printf("BEST %s\n", dispatch::level_names[int(dispatch::best().isa)].data());
+  for (auto kind : board_classes) {
+    generator<reachability::blocks::SRS, start, BOARD> g(kind, 1);
+    vector<array<uint64_t, HEIGHT>> rows(4096);
+    vector<int> pieces(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const auto record = g.next_record();
+      reachability::details::to_rows(record.board(), span{rows[i]});
+      pieces[i] = record.piece;
+    }
+    printf("CLASS %s\n", string(name_of(kind)).c_str());
+    const bench_scope scope{"CLASS " + string(name_of(kind))};
+    for (std::size_t v = 0; v < found.size(); ++v) {
+      const auto *variant = found[v];
+      const auto *kernel = variant->find(WIDTH, HEIGHT);
+      const auto name = dispatch::level_names[int(variant->isa)];
+      size_t next = 0;
+      auto isa_time = bench<10000000>(name, [&]{
+        array<uint64_t, 4 * HEIGHT> out;
+        const auto i = next++ % rows.size();
+        return kernel->binary_bfs(rows[i].data(), pieces[i], start[0_szc], start[1_szc], 0, out.data());
+      });
+      printf("  %-8s: %f cycles (%d-bit words, %d-bit simd)\n", name.data(), isa_time, variant->under_bits, variant->simd_bits);
+    }
+  }
+  return 0;
+}
+// what binary_bfs does on every board and piece: the last call in numbers and the mean cycles of every phase over
+// many calls, all of the histograms in json_path if it is given; only with REACHABILITY_STATS=1
+int print_stats(const string &json_path) {
+  namespace stats = reachability::stats;
+  using enum reachability::block_type;
+  if constexpr (!stats::enabled) {
+    fprintf(stderr, "built without REACHABILITY_STATS, build with -DREACHABILITY_STATS=1 (make stats)\n");
+    return 2;
+  }
+  ofstream out;
+  if (!json_path.empty()) {
+    out.open(json_path);
+    out << "{\n";
+  }
+  bool first = true;
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    for (auto block : {T, Z, S, J, L, O, I}) {
+      stats::reset();
+      for (int k = 0; k < 10000; ++k) {
+        DoNotOptimize(reachability::search::binary_bfs<reachability::blocks::SRS, reachability::coord{4, 20}>(BOARD(boards[i]), block));
+      }
+      const auto &c = stats::last();
+      const auto &total = stats::collected();
+      printf("BOARD %s\n", board_names[i]);
+      printf(" BLOCK %c\n", name_of(block));
+      printf("  fast path %s, %d outer, %d inner, %d kicks\n", c.fast_path ? "yes" : "no", c.outer, c.inner, c.kicks);
+      printf("  cycles  :");
+      for (int p = 0; p < stats::phases; ++p) {
+        printf(" %s %.1f", stats::phase_names[p].data(), double(total.total_cycles[p]) / total.calls);
+      }
+      printf("\n");
+      if (out.is_open()) {
+        out << (first ? "" : ",\n") << "  \"" << board_names[i] << "/" << name_of(block) << "\": ";
+        total.write_json(out);
+        first = false;
+      }
+    }
+  }
+  if (out.is_open()) {
+    out << "\n}\n";
+  }
+  return 0;
+}
+// bench [--json out.json] [--compare baseline.json] [--threshold percent] | --stats [--stats-json out.json] | --isa
+// --json writes every measurement with its percentiles and counters, --compare exits with 1 if the median or the
+// 99th percentile of any of them is more than threshold (5 by default) percent above the baseline;
+// --stats prints what binary_bfs does on every board (see print_stats) instead of timing anything,
+// --isa times only the kernels of every instruction set level (see test_isa)
+int main(int argc, char **argv) {
+  string json_path, baseline_path, stats_path;
+  double threshold = 5;
+  bool stats = false, isa = false;
+  for (int i = 1; i < argc; ++i) {
+    const string_view arg = argv[i];
+    if (i + 1 < argc && arg == "--json") {
+      json_path = argv[++i];
+    } else if (i + 1 < argc && arg == "--compare") {
+      baseline_path = argv[++i];
+    } else if (i + 1 < argc && arg == "--threshold") {
+      threshold = atof(argv[++i]);
+    } else if (arg == "--stats") {
+      stats = true;
+    } else if (arg == "--isa") {
+      isa = true;
+    } else if (i + 1 < argc && arg == "--stats-json") {
+      stats = true;
+      stats_path = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [--json out.json] [--compare baseline.json] [--threshold percent] | --stats [--stats-json out.json] | --isa\n", argv[0]);
+      return 2;
+    }
+  }
+  if (stats) {
+    return print_stats(stats_path);
+  }
+  if (isa) {
+    const int result = test_isa();
+    if (result == 0 && !json_path.empty()) {
+      ofstream out(json_path);
+      bench_log::get().write_json(out);
+    }
+    return result;
+  }
+  map<string, bench_stats> baseline;
+  if (!baseline_path.empty()) {
+    ifstream in(baseline_path);
+    if (!in) {
+      fprintf(stderr, "cannot read %s\n", baseline_path.c_str());
+      return 2;
+    }
+    baseline = bench_log::read_json(in);
+  }
+  double binary_sum = 0, column_sum = 0, hard_sum = 0, runtime_sum = 0;
   unsigned count = 0;
   using enum reachability::block_type;
   constexpr reachability::block_type blocks[] = {T, Z, S, J, L, O, I};
   for (size_t i = 0; i < board_names.size(); ++i) {
     for (auto block : blocks) {
-      auto binary_time = test(boards[i], board_names[i], block);
+      auto [binary_time, column_time, hard_time, runtime_time] = test(boards[i], board_names[i], block);
       binary_sum += binary_time;
+      column_sum += column_time;
+      hard_sum += hard_time;
+      runtime_sum += runtime_time;
       count++;
     }
   }
   printf("AVARAGE binary  : %f cycles\n", binary_sum / count);
-}
\ No newline at end of file
+  printf("AVARAGE column  : %f cycles\n", column_sum / count);
+  printf("AVARAGE hard    : %f cycles\n", hard_sum / count);
+  printf("AVARAGE runtime : %f cycles\n", runtime_sum / count);
+  double pieces_sum = 0;
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    pieces_sum += test_pieces(boards[i], board_names[i]);
+  }
+  printf("AVARAGE pieces  : %f cycles for all 7 (%f cycles as separate calls)\n", pieces_sum / board_names.size(), binary_sum / count * std::size(blocks));
+  double successors_sum = 0;
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    successors_sum += test_successors(boards[i], board_names[i]);
+  }
+  printf("AVARAGE lock    : %f cycles for all 7\n", successors_sum / board_names.size());
+  double step_sum = 0, log_step_sum = 0;
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    using enum reachability::search::closure;
+    const bench_scope board_scope{board_names[i]}, block_scope{"T"};
+    const auto [steps, step_time] = test_closure<step>(boards[i]);
+    const auto [log_steps, log_step_time] = test_closure<log_step>(boards[i]);
+    printf("BOARD %s\n", board_names[i]);
+    printf(" BLOCK T\n");
+    printf("  step    : %f cycles (%d iterations)\n", step_time, int(steps));
+    printf("  log_step: %f cycles (%d iterations)\n", log_step_time, int(log_steps));
+    step_sum += step_time;
+    log_step_sum += log_step_time;
+  }
+  printf("AVARAGE step    : %f cycles\n", step_sum / board_names.size());
+  printf("AVARAGE log_step: %f cycles\n", log_step_sum / board_names.size());
+  double compiled_sum = 0, interp_sum = 0;
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    for (auto block : blocks) {
+      auto [compiled_time, interp_time] = test_rules(boards[i], board_names[i], block);
+      compiled_sum += compiled_time;
+      interp_sum += interp_time;
+    }
+  }
+  printf("AVARAGE compiled: %f cycles\n", compiled_sum / count);
+  printf("AVARAGE interp  : %f cycles (%.2fx)\n", interp_sum / count, interp_sum / compiled_sum);
+  for (const auto &geometry : reachability::default_registry<reachability::blocks::SRS>::handles) {
+    double geometry_sum = 0;
+    for (size_t i = 0; i < board_names.size(); ++i) {
+      geometry_sum += test_geometry(boards[i], board_names[i], geometry);
+    }
+    printf("AVARAGE %dx%d  : %f cycles\n", geometry.width, geometry.height, geometry_sum / board_names.size());
+  }
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    test_beam(boards[i], board_names[i]);
+  }
+  for (int stack : {0, 4, 8, 12, 16, 24}) {
+    test_window(stack);
+  }
+  for (auto kind : reachability::corpus::board_classes) {
+    test_class(kind);
+  }
+  test_throughput();
+  for (size_t i = 0; i < board_names.size(); ++i) {
+    test_cache(boards[i], board_names[i]);
+  }
+  test_pc();
+  double batch_sum = 0;
+  const auto batch = board_batch();
+  for (auto block : blocks) {
+    batch_sum += test_batch(batch, block);
+  }
+  printf("AVARAGE batch   : %f cycles per board\n", batch_sum / std::size(blocks));
+  if (!json_path.empty()) {
+    ofstream out(json_path);
+    bench_log::get().write_json(out);
+  }
+  if (!baseline_path.empty()) {
+    const int regressions = bench_log::get().compare(baseline, threshold / 100);
+    printf("%d REGRESSIONS OVER %.1f%%\n", regressions, threshold);
+    return regressions ? 1 : 0;
+  }
+}
@@ -1,18 +1,40 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <initializer_list>
+#include <map>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <chrono>
+#include <vector>
 #include "board.hpp"
+#include "board_batch.hpp"
+#include "column_board.hpp"
 
 #ifdef _MSC_VER
 #include <intrin.h>
 #else
 #include <x86intrin.h>
 #endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 constexpr int WIDTH = 10, HEIGHT = 24;
 using BOARD = reachability::board_t<WIDTH, HEIGHT>;
+using COLUMN_BOARD = reachability::column_board_t<WIDTH, HEIGHT>;
+constexpr std::size_t LANES = std::experimental::native_simd<std::uint64_t>::size();
+using BATCH = reachability::board_batch_t<WIDTH, HEIGHT, LANES>;
 constexpr auto merge_str(std::initializer_list<std::string_view> &&b_str) {
   std::array<char, WIDTH*HEIGHT> res = {};
   unsigned pos = 0;
@@ -82,6 +104,14 @@ inline constexpr std::array boards = {
 inline constexpr std::array board_names = {
   "LEMONTEA TSPIN", "LEMONTEA DT", "LEMONTEA TERRIBLE", "4T"
 };
+inline BATCH board_batch() {
+  // cycle through the sample boards to fill every lane
+  BATCH batch;
+  for (std::size_t i = 0; i < LANES; ++i) {
+    batch.set_lane(i, boards[i % boards.size()]);
+  }
+  return batch;
+}
 
 // from https://github.com/facebook/folly/blob/7a3f5e4e81bc83a07036e2d1d99d6a5bf5932a48/folly/lang/Hint-inl.h#L107
 // Apache License 2.0
@@ -94,13 +124,302 @@ inline void DoNotOptimize(const Tp &value) {
   asm volatile("" : : "m"(value) : "memory");
 }
 
+// cycles of single calls, in buckets of 1/32 of a power of two, so percentiles are within about 3%
+class cycle_histogram {
+public:
+  static constexpr int sub_bits = 5;
+  static constexpr int sub = 1 << sub_bits;
+  void add(std::uint64_t cycles) {
+    ++counts[bucket(cycles)];
+    ++total;
+    sum += cycles;
+    max = std::max(max, cycles);
+  }
+  std::uint64_t size() const {
+    return total;
+  }
+  double mean() const {
+    return total ? double(sum) / total : 0;
+  }
+  // the middle of the bucket holding the q-th quantile
+  double quantile(double q) const {
+    const std::uint64_t rank = std::max<std::uint64_t>(std::ceil(q * total), 1);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < int(counts.size()); ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(lower(i) + (lower(i + 1) - lower(i) - 1) / 2.0, double(max));
+      }
+    }
+    return max;
+  }
+  std::uint64_t maximum() const {
+    return max;
+  }
+private:
+  static int bucket(std::uint64_t v) {
+    if (v < sub) {
+      return v;
+    }
+    const int e = std::bit_width(v) - 1;
+    return (e - sub_bits + 1) * sub + int(v >> (e - sub_bits)) - sub;
+  }
+  static double lower(int i) {
+    if (i < sub) {
+      return i;
+    }
+    const int e = i / sub + sub_bits - 1;
+    return std::ldexp(double(i % sub + sub), e - sub_bits);
+  }
+  std::array<std::uint64_t, (64 - sub_bits + 1) * sub> counts = {};
+  std::uint64_t total = 0, sum = 0, max = 0;
+};
+
+// hardware counters of the calling thread through perf_event_open; an event the kernel refuses
+// (no permission, a virtual machine without a pmu) reads as nullopt
+class perf_counters {
+public:
+  enum event { core_cycles, instructions, branch_misses, l1d_misses, events };
+  static constexpr std::array<std::string_view, events> names = {"core_cycles", "instructions", "branch_misses", "l1d_misses"};
+  perf_counters() {
+    fds.fill(-1);
+#ifdef __linux__
+    constexpr std::array<std::pair<std::uint32_t, std::uint64_t>, events> configs = {{
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16}
+    }};
+    for (int i = 0; i < events; ++i) {
+      perf_event_attr attr = {};
+      attr.size = sizeof(attr);
+      attr.type = configs[i].first;
+      attr.config = configs[i].second;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+  }
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+  ~perf_counters() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+  void start() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+  std::array<std::optional<double>, events> stop() {
+    std::array<std::optional<double>, events> ret;
+#ifdef __linux__
+    for (int i = 0; i < events; ++i) {
+      std::uint64_t value;
+      if (fds[i] >= 0 && ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0) == 0 && read(fds[i], &value, sizeof(value)) == sizeof(value)) {
+        ret[i] = value;
+      }
+    }
+#endif
+    return ret;
+  }
+private:
+  std::array<int, events> fds;
+};
+
+struct bench_stats {
+  std::uint64_t iterations;
+  double mean;                        // cycles per call, calls back to back
+  double p50, p90, p99, p999, max;    // cycles of a single call, fenced and without the timer
+  std::array<std::optional<double>, perf_counters::events> counters; // per call, back to back
+};
+
+// every measurement of the run by name, "<scope>/.../<name>"
+class bench_log {
+public:
+  static bench_log &get() {
+    static bench_log log;
+    return log;
+  }
+  void record(std::string_view name, const bench_stats &stats) {
+    std::string key;
+    for (const auto &scope : scopes) {
+      key += scope + "/";
+    }
+    key += name;
+    // the same measurement taken twice keeps both, the second as "name#2"
+    const std::string base = key;
+    for (int i = 2; entries.contains(key); ++i) {
+      key = base + "#" + std::to_string(i);
+    }
+    entries.emplace(key, stats);
+  }
+  const std::map<std::string, bench_stats> &results() const {
+    return entries;
+  }
+  void write_json(std::ostream &out) const {
+    out << "{\n";
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      const auto &s = it->second;
+      char line[512];
+      std::snprintf(line, sizeof(line), "{\"iterations\": %llu, \"mean\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f",
+        (unsigned long long)s.iterations, s.mean, s.p50, s.p90, s.p99, s.p999, s.max);
+      out << "  \"" << escape(it->first) << "\": " << line;
+      for (int i = 0; i < perf_counters::events; ++i) {
+        out << ", \"" << perf_counters::names[i] << "\": ";
+        if (s.counters[i]) {
+          std::snprintf(line, sizeof(line), "%.3f", *s.counters[i]);
+          out << line;
+        } else {
+          out << "null";
+        }
+      }
+      out << (std::next(it) == entries.end() ? "}\n" : "},\n");
+    }
+    out << "}\n";
+  }
+  // the entries of a file from write_json, only the fields compare looks at are read
+  static std::map<std::string, bench_stats> read_json(std::istream &in) {
+    std::map<std::string, bench_stats> ret;
+    for (std::string line; std::getline(in, line);) {
+      const std::size_t open = line.find('"');
+      std::size_t close = open;
+      std::string key;
+      while (open != std::string::npos && ++close < line.size() && line[close] != '"') {
+        if (line[close] == '\\' && close + 1 < line.size()) {
+          ++close;
+        }
+        key += line[close];
+      }
+      if (open == std::string::npos || close >= line.size()) {
+        continue;
+      }
+      const auto field = [&](std::string_view name) {
+        const std::size_t pos = line.find("\"" + std::string(name) + "\": ", close);
+        return pos == std::string::npos ? NAN : std::strtod(line.c_str() + pos + name.size() + 4, nullptr);
+      };
+      ret[key] = bench_stats{std::uint64_t(field("iterations")), field("mean"), field("p50"), field("p90"), field("p99"), field("p999"), field("max"), {}};
+    }
+    return ret;
+  }
+  // prints every measurement whose median or 99th percentile is more than threshold (0.05 for 5%) above the baseline,
+  // returns how many there are
+  int compare(const std::map<std::string, bench_stats> &baseline, double threshold) const {
+    int regressions = 0;
+    for (const auto &[key, s] : entries) {
+      const auto it = baseline.find(key);
+      if (it == baseline.end()) {
+        std::printf("NEW        %s\n", key.c_str());
+        continue;
+      }
+      const auto &b = it->second;
+      const bool regressed = s.p50 > b.p50 * (1 + threshold) || s.p99 > b.p99 * (1 + threshold);
+      const bool improved = s.p50 < b.p50 * (1 - threshold) && s.p99 < b.p99 * (1 - threshold);
+      if (regressed || improved) {
+        std::printf("%s %s: p50 %.1f -> %.1f (%+.1f%%), p99 %.1f -> %.1f (%+.1f%%)\n", regressed ? "REGRESSION" : "IMPROVED  ", key.c_str(),
+          b.p50, s.p50, (s.p50 / b.p50 - 1) * 100, b.p99, s.p99, (s.p99 / b.p99 - 1) * 100);
+      }
+      regressions += regressed;
+    }
+    for (const auto &[key, b] : baseline) {
+      if (!entries.contains(key)) {
+        std::printf("MISSING    %s\n", key.c_str());
+      }
+    }
+    return regressions;
+  }
+private:
+  friend class bench_scope;
+  static std::string escape(std::string_view s) {
+    std::string ret;
+    for (char c : s) {
+      if (c == '"' || c == '\\') {
+        ret += '\\';
+      }
+      ret += c;
+    }
+    return ret;
+  }
+  std::vector<std::string> scopes;
+  std::map<std::string, bench_stats> entries;
+};
+// prefixes the names of the measurements taken while it lives
+class bench_scope {
+public:
+  explicit bench_scope(std::string name) {
+    bench_log::get().scopes.push_back(std::move(name));
+  }
+  bench_scope(const bench_scope &) = delete;
+  bench_scope &operator=(const bench_scope &) = delete;
+  ~bench_scope() {
+    bench_log::get().scopes.pop_back();
+  }
+};
+
+namespace details {
+  // [[gnu::always_inline]] keeps the call out of the measurement
+  [[gnu::always_inline]] inline std::uint64_t fenced_rdtsc() {
+    _mm_lfence();
+    const std::uint64_t ret = __rdtsc();
+    _mm_lfence();
+    return ret;
+  }
+  template <int count>
+  cycle_histogram sample(auto f, auto &&...args) {
+    cycle_histogram ret;
+    for (int _ = 0; _ < count; ++_) {
+      (void)(DoNotOptimize(args), ...);
+      const std::uint64_t start = fenced_rdtsc();
+      DoNotOptimize(f(args...));
+      ret.add(fenced_rdtsc() - start);
+    }
+    return ret;
+  }
+  // the cycles the timer adds to every sample, taken off every percentile
+  inline double timer_overhead() {
+    static const double overhead = sample<1000000>([] { return 0; }).quantile(0.5);
+    return overhead;
+  }
+}
+
+// runs f(args...) count times back to back for the mean cycles and the counters (as the old single loop did), then
+// times count calls one by one for the percentiles; records both in bench_log under name and returns the mean
 template <int count = 50000>
-auto bench(auto f, auto &&...args) {
-  auto start = __rdtsc();
+double bench(std::string_view name, auto f, auto &&...args) {
+  static perf_counters counters;
+  const double overhead = details::timer_overhead();
+  details::sample<std::max(count / 100, 1)>(f, args...);
+  counters.start();
+  const auto start = __rdtsc();
   for (int _ = 0; _ < count; ++_) {
     (void)(DoNotOptimize(args), ...);
     DoNotOptimize(f(args...));
   }
-  auto end = __rdtsc();
-  return double(end - start) / count;
-}
\ No newline at end of file
+  const auto end = __rdtsc();
+  const auto totals = counters.stop();
+  const cycle_histogram samples = details::sample<count>(f, args...);
+  const auto latency = [&](double c) {
+    return std::max(c - overhead, 0.0);
+  };
+  bench_stats stats{samples.size(), double(end - start) / count, latency(samples.quantile(0.5)), latency(samples.quantile(0.9)),
+    latency(samples.quantile(0.99)), latency(samples.quantile(0.999)), latency(samples.maximum()), {}};
+  for (int i = 0; i < perf_counters::events; ++i) {
+    if (totals[i]) {
+      stats.counters[i] = *totals[i] / count;
+    }
+  }
+  bench_log::get().record(name, stats);
+  return stats.mean;
+}
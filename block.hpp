@@ -3,7 +3,7 @@
 #include <utility>
 #include "utils.hpp"
 
-namespace reachability {
+namespace reachability::inline REACHABILITY_ISA {
   using coord = tuple<int, int>;
   constexpr coord operator-(const coord &co) {
     return {-co[0_szc], -co[1_szc]};
@@ -82,7 +82,7 @@ namespace reachability {
     kicks_t kicks;
   };
 }
-namespace reachability::blocks {
+namespace reachability::inline REACHABILITY_ISA::blocks {
   template <Wrap<mino_p> auto mino>
   constexpr std::array<int, 4> mino_range() {
     static_assert(std::tuple_size_v<decltype(mino)> >= 1);
@@ -226,4 +226,59 @@ namespace reachability::blocks {
     }}, I_kick>;
     SRS() = delete;
   };
+
+  // SRS with the 180 rotations of SRS+, the I piece kicks from the same true rotation as its 90 kicks
+  struct SRS_plus {
+    static constexpr pure_kick common_kick{tuple{
+      tuple{tuple{0, 1}, tuple{coord{0, 0}, coord{-1, 0}, coord{-1, 1}, coord{0, -2}, coord{-1, -2}}},  // 0 -> R
+      tuple{tuple{0, 3}, tuple{coord{0, 0}, coord{1, 0}, coord{1, 1}, coord{0, -2}, coord{1, -2}}},     // 0 -> L
+      tuple{tuple{1, 2}, tuple{coord{0, 0}, coord{1, 0}, coord{1, -1}, coord{0, 2}, coord{1, 2}}},      // R -> 2
+      tuple{tuple{1, 0}, tuple{coord{0, 0}, coord{1, 0}, coord{1, -1}, coord{0, 2}, coord{1, 2}}},      // R -> 0
+      tuple{tuple{2, 3}, tuple{coord{0, 0}, coord{1, 0}, coord{1, 1}, coord{0, -2}, coord{1, -2}}},     // 2 -> L
+      tuple{tuple{2, 1}, tuple{coord{0, 0}, coord{-1, 0}, coord{-1, 1}, coord{0, -2}, coord{-1, -2}}},  // 2 -> R
+      tuple{tuple{3, 0}, tuple{coord{0, 0}, coord{-1, 0}, coord{-1, -1}, coord{0, 2}, coord{-1, 2}}},   // L -> 0
+      tuple{tuple{3, 2}, tuple{coord{0, 0}, coord{-1, 0}, coord{-1, -1}, coord{0, 2}, coord{-1, 2}}},   // L -> 2
+      tuple{tuple{0, 2}, tuple{coord{0, 0}, coord{0, 1}, coord{1, 1}, coord{-1, 1}, coord{1, 0}, coord{-1, 0}}},      // 0 -> 2
+      tuple{tuple{2, 0}, tuple{coord{0, 0}, coord{0, -1}, coord{-1, -1}, coord{1, -1}, coord{-1, 0}, coord{1, 0}}},   // 2 -> 0
+      tuple{tuple{1, 3}, tuple{coord{0, 0}, coord{1, 0}, coord{1, 2}, coord{1, 1}, coord{0, 2}, coord{0, 1}}},        // R -> L
+      tuple{tuple{3, 1}, tuple{coord{0, 0}, coord{-1, 0}, coord{-1, 2}, coord{-1, 1}, coord{0, 2}, coord{0, 1}}},     // L -> R
+    }};
+    static constexpr pure_kick I_kick{tuple{
+      tuple{tuple{0, 1}, tuple{coord{1, 0}, coord{-1, 0}, coord{2, 0}, coord{-1, -1}, coord{2, 2}}},    // 0 -> R
+      tuple{tuple{0, 3}, tuple{coord{0, -1}, coord{-1, -1}, coord{2, -1}, coord{-1, 1}, coord{2, -2}}}, // 0 -> L
+      tuple{tuple{1, 2}, tuple{coord{0, -1}, coord{-1, -1}, coord{2, -1}, coord{-1, 1}, coord{2, -2}}}, // R -> 2
+      tuple{tuple{1, 0}, tuple{coord{-1, 0}, coord{1, 0}, coord{-2, 0}, coord{1, 1}, coord{-2, -2}}},   // R -> 0
+      tuple{tuple{2, 3}, tuple{coord{-1, 0}, coord{1, 0}, coord{-2, 0}, coord{1, 1}, coord{-2, -2}}},   // 2 -> L
+      tuple{tuple{2, 1}, tuple{coord{0, 1}, coord{1, 1}, coord{-2, 1}, coord{1, -1}, coord{-2, 2}}},    // 2 -> R
+      tuple{tuple{3, 0}, tuple{coord{0, 1}, coord{1, 1}, coord{-2, 1}, coord{1, -1}, coord{-2, 2}}},    // L -> 0
+      tuple{tuple{3, 2}, tuple{coord{1, 0}, coord{-1, 0}, coord{2, 0}, coord{-1, -1}, coord{2, 2}}},    // L -> 2
+      tuple{tuple{0, 2}, tuple{coord{1, -1}, coord{1, 0}, coord{2, 0}, coord{0, 0}, coord{2, -1}, coord{0, -1}}},     // 0 -> 2
+      tuple{tuple{2, 0}, tuple{coord{-1, 1}, coord{-1, 0}, coord{-2, 0}, coord{0, 0}, coord{-2, 1}, coord{0, 1}}},    // 2 -> 0
+      tuple{tuple{1, 3}, tuple{coord{-1, -1}, coord{0, -1}, coord{0, 1}, coord{0, 0}, coord{-1, 1}, coord{-1, 0}}},   // R -> L
+      tuple{tuple{3, 1}, tuple{coord{1, 1}, coord{0, 1}, coord{0, 3}, coord{0, 2}, coord{1, 3}, coord{1, 2}}},        // L -> R
+    }};
+    static constexpr auto T = combine<convert(blocks::T), common_kick>;
+    static constexpr auto Z = combine<block_with_offset{blocks::Z.minos, tuple{
+      tuple{0, coord{0, 0}},
+      tuple{1, coord{1, 0}},
+      tuple{0, coord{0, -1}},
+      tuple{1, coord{0, 0}},
+    }}, common_kick>;
+    static constexpr auto S = combine<block_with_offset{blocks::S.minos, tuple{
+      tuple{0, coord{0, 0}},
+      tuple{1, coord{1, 0}},
+      tuple{0, coord{0, -1}},
+      tuple{1, coord{0, 0}},
+    }}, common_kick>;
+    static constexpr auto J = combine<convert(blocks::J), common_kick>;
+    static constexpr auto L = combine<convert(blocks::L), common_kick>;
+    static constexpr auto O = combine<convert(blocks::O), no_rotation>;
+    static constexpr auto I = combine<block_with_offset{blocks::I.minos, tuple{
+      tuple{0, coord{0, 0}},
+      tuple{1, coord{0, -1}},
+      tuple{0, coord{-1, 0}},
+      tuple{1, coord{0, 0}},
+    }}, I_kick>;
+    SRS_plus() = delete;
+  };
 }
@@ -7,9 +7,38 @@
 #include <type_traits>
 #include <cstdint>
 #include <bit>
+#include <span>
 #include <experimental/simd>
+#if defined(__BMI2__) || defined(__AVX512VBMI2__)
+#include <immintrin.h>
+#endif
 
-namespace reachability {
+namespace reachability::inline REACHABILITY_ISA {
+  namespace details {
+    // write the index of every set bit of word to out (which has room for 64 entries), returns the count
+    inline std::size_t bit_indices(std::uint64_t word, std::uint8_t *out) {
+      const std::size_t count = std::popcount(word);
+#ifdef __AVX512VBMI2__
+      static constexpr auto iota = []{
+        std::array<std::uint8_t, 64> ret;
+        for (int i = 0; i < 64; ++i) ret[i] = i;
+        return ret;
+      }();
+      _mm512_storeu_si512(out, _mm512_maskz_compress_epi8(word, _mm512_loadu_si512(iota.data())));
+#else
+      for (std::size_t i = 0; i < count; ++i, word &= word - 1) {
+        out[i] = std::countr_zero(word);
+      }
+#endif
+      return count;
+    }
+  }
+  template <typename board_t>
+  struct clear_result {
+    board_t board;
+    int lines;
+    std::uint64_t rows; // bit y is set iff line y was cleared
+  };
   template <unsigned W, unsigned H, typename under_t=std::uint64_t>
     requires
       std::numeric_limits<under_t>::is_integer
@@ -27,6 +56,11 @@ namespace reachability {
     static constexpr under_t mask = under_t(-1) >> remaining_per_under;
     static constexpr int remaining_in_last = num_of_under * used_bits_per_under - H * W;
     static constexpr under_t last_mask = mask >> remaining_in_last;
+    // words in one simd register of the target
+    static constexpr int native_words = std::experimental::native_simd<under_t>::size();
+    // the same layout with another height, the lines of the lowest words are where they were
+    template <unsigned H2>
+    using with_height = board_t<W, H2, under_t>;
     constexpr board_t() = default;
     constexpr board_t(std::string_view s): board_t(convert_to_array(s)) {}
     constexpr board_t(std::array<under_t, num_of_under> d): data{d.data(), std::experimental::element_aligned} {}
@@ -38,10 +72,18 @@ namespace reachability {
       data[last] = convert_to_under_t(s.substr(0, used_bits_per_under - remaining_in_last));
       return data;
     }
+    constexpr std::array<under_t, num_of_under> to_array() const {
+      std::array<under_t, num_of_under> ret;
+      data.copy_to(ret.data(), std::experimental::element_aligned);
+      return ret;
+    }
     template <int x, int y>
     constexpr void set() {
       data[y / lines_per_under] |= under_t(1) << ((y % lines_per_under) * W + x);
     }
+    constexpr void set(int x, int y) {
+      data[y / lines_per_under] |= under_t(1) << ((y % lines_per_under) * W + x);
+    }
     template <int x, int y>
     constexpr int get() const {
       if ((x < 0) || (x >= W) || (y < 0) || (y >= H)) {
@@ -49,6 +91,12 @@ namespace reachability {
       }
       return data[y / lines_per_under] & (under_t(1) << ((y % lines_per_under) * W + x)) ? 1 : 0;
     }
+    constexpr int get(int x, int y) const {
+      if ((x < 0) || (x >= int(W)) || (y < 0) || (y >= int(H))) {
+        return 2;
+      }
+      return data[y / lines_per_under] & (under_t(1) << ((y % lines_per_under) * W + x)) ? 1 : 0;
+    }
     template <int y>
     constexpr int get() const {
       // use highest bit as the result
@@ -95,16 +143,26 @@ namespace reachability {
       result ^= rhs;
       return result;
     }
+    // the words of put<mino>(x, y) at index y * W + x, the cells outside the board left out.
+    // built by the compiler, so reading them needs no guard and no static initialization
+    template <Wrap<mino_p> auto mino>
+    alignas(64) static constexpr std::array<std::array<under_t, num_of_under>, W * H> placements = []{
+      std::array<std::array<under_t, num_of_under>, W * H> ret = {};
+      for (int y = 0; y < int(H); ++y) {
+        for (int x = 0; x < int(W); ++x) {
+          static_for<std::tuple_size_v<decltype(mino)>>([&](auto i) {
+            const int cx = x + mino[i][0_szc], cy = y + mino[i][1_szc];
+            if (cx >= 0 && cx < int(W) && cy >= 0 && cy < int(H)) {
+              ret[y * W + x][cy / lines_per_under] |= under_t(1) << (cy % lines_per_under * W + cx);
+            }
+          });
+        }
+      }
+      return ret;
+    }();
     template <Wrap<mino_p> auto mino>
     static constexpr board_t put(int x, int y) {
-      constexpr auto range = blocks::mino_range<mino>();
-      constexpr int min_x = range[0];
-      board_t shape = shapes<mino>[y % lines_per_under];
-      static_for<num_of_under>([&](auto i) {
-        if (y / lines_per_under == i) shape.template move_<coord{0, (int(i) - 1) * lines_per_under}>();
-      });
-      shape.data <<= x + min_x;
-      return shape;
+      return placements<mino>[y * W + x];
     }
     template <coord d, bool check = true>
     constexpr void move_() {
@@ -139,6 +197,36 @@ namespace reachability {
       result.move_<d, check>();
       return result;
     }
+    constexpr board_t move(int dx, int dy) const {
+      // runtime counterpart of move<coord{dx, dy}>(), always checked
+      if (dx >= int(W) || -dx >= int(W) || dy >= int(H) || -dy >= int(H)) {
+        return {};
+      }
+      const auto words = to_array();
+      // word i takes lines from words i + pad and i + pad + 1, starting at line shift of the first one
+      const int pad = (-dy >= 0 ? -dy : -dy - lines_per_under + 1) / lines_per_under;
+      const int shift = -dy - pad * lines_per_under;
+      under_t columns = mask;
+      if (dx > 0) {
+        columns = ((line_bits << dx) & line_bits) * one_bit_of_lines();
+      } else if (dx < 0) {
+        columns = (line_bits >> -dx) * one_bit_of_lines();
+      }
+      std::array<under_t, num_of_under> ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        const int from = int(i) + pad;
+        under_t word = 0;
+        if (from >= 0 && from < num_of_under) {
+          word |= words[from] >> (shift * W);
+        }
+        if (shift && from + 1 >= 0 && from + 1 < num_of_under) {
+          word |= words[from + 1] << ((lines_per_under - shift) * W);
+        }
+        word = dx >= 0 ? under_t(word << dx) : under_t(word >> -dx);
+        ret[i] = word & columns & (i == last ? last_mask : mask);
+      });
+      return ret;
+    }
     friend constexpr std::string to_string(board_t board) {
       std::string ret;
       static_for<H>([&][[gnu::always_inline]](auto y) {
@@ -190,22 +278,47 @@ namespace reachability {
       });
       return ret;
     }
-    constexpr auto clear_full_lines() const {
-      auto is_full = all_bits();
-      int lines = 0;
-      const auto remove_range = [](board_t board, unsigned start) {
-        auto below = board & full_lines_of(start);
-        auto above = board.move<coord{0, -1}>() & ~full_lines_of(start);
-        return below | above;
-      };
-      auto copied = *this;
-      static_for<H>([&][[gnu::always_inline]](auto y){
-        if (is_full.template get<y>()) {
-          copied = remove_range(copied, y - lines);
-          ++lines;
-        }
+    constexpr std::uint64_t full_rows() const {
+      // bit y of the result is set iff line y is full
+      static_assert(H <= 64);
+      const auto full = all_bits().to_array();
+      std::uint64_t rows = 0;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        rows |= std::uint64_t(gather_lines(full[i])) << (i * lines_per_under);
+      });
+      return rows;
+    }
+    static constexpr board_t lines(std::uint64_t rows) {
+      // bit y of rows fills line y
+      static_assert(H <= 64);
+      std::array<under_t, num_of_under> ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret[i] = spread_lines(under_t(rows >> (i * lines_per_under)) & all_lines) & (i == last ? last_mask : mask);
+      });
+      return ret;
+    }
+    constexpr board_t remove_lines(std::uint64_t rows) const {
+      // compact every word on its own, then stitch the words back together at the running line count
+      const auto words = to_array();
+      std::array<under_t, num_of_under + 1> result = {};
+      int pos = 0;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        const under_t kept = ~under_t(rows >> (i * lines_per_under)) & all_lines;
+        const under_t compacted = compact_lines(words[i], kept);
+        const int shift = pos % lines_per_under * W;
+        result[pos / lines_per_under] |= compacted << shift;
+        result[pos / lines_per_under + 1] |= shift ? compacted >> (used_bits_per_under - shift) : 0;
+        pos += std::popcount(kept);
+      });
+      std::array<under_t, num_of_under> ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret[i] = result[i] & (i == last ? last_mask : mask);
       });
-      return std::pair{copied, lines};
+      return ret;
+    }
+    constexpr clear_result<board_t> clear_full_lines() const {
+      const auto rows = full_rows();
+      return {remove_lines(rows), std::popcount(rows), rows};
     }
     constexpr board_t has_single_bit() const {
       auto saturated = data | one_bit<W - 1>();
@@ -263,6 +376,27 @@ namespace reachability {
       const auto heads = starts.data | (ends.data + (possible & ~all_heads).data);
       return to_board(heads);
     }
+    constexpr int count() const {
+      int ret = 0;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret += std::popcount(under_t(data[i]));
+      });
+      return ret;
+    }
+    // write the position of every set bit to out, which must hold count() entries
+    std::size_t extract(std::span<coord> out) const {
+      std::size_t n = 0;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        std::array<std::uint8_t, 64> indices;
+        const std::size_t found = details::bit_indices(data[i], indices.data());
+        for (std::size_t j = 0; j < found; ++j) {
+          const int pos = indices[j];
+          out[n + j] = coord{pos % W, pos / W + int(i) * lines_per_under};
+        }
+        n += found;
+      });
+      return n;
+    }
     template <class F>
     void for_each_bit(F &&f) const {
       reachability::static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
@@ -351,6 +485,53 @@ namespace reachability {
       }
       return data;
     }
+    static constexpr under_t all_lines = (under_t(-1) >> (under_bits - lines_per_under));
+    static constexpr under_t line_bits = (under_t(-1) >> (under_bits - W));
+    static constexpr under_t spread_lines(under_t lines) {
+      // bit i of lines becomes the whole line i
+#ifdef __BMI2__
+      return under_t(_pdep_u64(lines, one_bit_of_lines())) * line_bits;
+#else
+      under_t ret = 0;
+      static_for<lines_per_under>([&][[gnu::always_inline]](auto i) {
+        ret |= ((lines >> i) & 1) * (line_bits << (i * W));
+      });
+      return ret;
+#endif
+    }
+    static constexpr under_t gather_lines(under_t word) {
+      // the highest bit of line i becomes bit i
+#ifdef __BMI2__
+      return under_t(_pext_u64(word, one_bit_of_lines() << (W - 1)));
+#else
+      under_t ret = 0;
+      static_for<lines_per_under>([&][[gnu::always_inline]](auto i) {
+        ret |= ((word >> (i * W + W - 1)) & 1) << i;
+      });
+      return ret;
+#endif
+    }
+    static constexpr under_t compact_lines(under_t word, under_t kept) {
+      // move the kept lines of word down to the lowest lines, without branches
+#ifdef __BMI2__
+      return under_t(_pext_u64(word, spread_lines(kept)));
+#else
+      under_t ret = 0;
+      int pos = 0;
+      static_for<lines_per_under>([&][[gnu::always_inline]](auto i) {
+        ret |= ((word >> (i * W)) & line_bits & -((kept >> i) & 1)) << (pos * W);
+        pos += (kept >> i) & 1;
+      });
+      return ret;
+#endif
+    }
+    static constexpr under_t one_bit_of_lines() {
+      under_t ret = 0;
+      for (int i = 0; i < lines_per_under; ++i) {
+        ret |= under_t(1) << (i * W);
+      }
+      return ret;
+    }
     static constexpr under_t convert_to_under_t(std::string_view in) {
       under_t res = 0;
       for (char c : in) {
@@ -360,26 +541,38 @@ namespace reachability {
       }
       return res;
     }
-    template <Wrap<mino_p> auto mino>
-    static constexpr board_t standard_shape() {
-      auto [min_x, min_y, max_x, max_y] = blocks::mino_range<mino>();
-      board_t b;
-      static_for<std::tuple_size_v<decltype(mino)>>([&](auto i){
-        int x = mino[i][0_szc], y = mino[i][1_szc];
-        b.set(x - min_x, y - min_y);
-      });
-      return b;
-    }
-    template <Wrap<mino_p> auto mino, int y>
-    static constexpr board_t shape_at_y() {
-      constexpr auto range = blocks::mino_range<mino>();
-      return standard_shape<mino>().template move<coord{0, y + range[1] + lines_per_under}>();
-    }
-    template <Wrap<mino_p> auto mino>
-    inline static std::array<board_t, lines_per_under> shapes = []{
-      std::array<board_t, lines_per_under> shapes;
-      static_for<lines_per_under>([&](auto i) { shapes[i].data = shape_at_y<mino, i>().data; });
-      return shapes;
-    }();
   };
-}
\ No newline at end of file
+
+  // lock mino at every position on top of base and clear lines for each result
+  // base is shared by all placements, and most of them clear nothing, so that case skips the compaction
+  template <Wrap<mino_p> auto mino, typename board_t>
+  constexpr void lock_each(board_t base, std::span<const coord> positions, std::span<clear_result<board_t>> out) {
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      const auto &[x, y] = positions[i];
+      const board_t locked = base | board_t::template put<mino>(x, y);
+      const auto rows = locked.full_rows();
+      out[i] = {rows ? locked.remove_lines(rows) : locked, std::popcount(rows), rows};
+    }
+  }
+
+  // f(x, y, clear_result) for mino locked on base at every bit of landable, with lines cleared;
+  // the pieces come straight from the placement table, the positions are never written out
+  template <Wrap<mino_p> auto mino, typename board_t, typename F>
+  void for_each_lock(board_t base, board_t landable, F &&f) {
+    constexpr auto &table = board_t::template placements<mino>;
+    landable.for_each_bit([&][[gnu::always_inline]](int x, int y) {
+      const board_t locked = base | board_t(table[y * board_t::width + x]);
+      const auto rows = locked.full_rows();
+      f(x, y, clear_result<board_t>{rows ? locked.remove_lines(rows) : locked, std::popcount(rows), rows});
+    });
+  }
+  // every board of for_each_lock, out must hold landable.count() entries; returns the count
+  template <Wrap<mino_p> auto mino, typename board_t>
+  std::size_t lock_landable(board_t base, board_t landable, std::span<clear_result<board_t>> out) {
+    std::size_t n = 0;
+    for_each_lock<mino>(base, landable, [&](int, int, const clear_result<board_t> &result) {
+      out[n++] = result;
+    });
+    return n;
+  }
+}
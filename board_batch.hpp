@@ -0,0 +1,286 @@
+#pragma once
+#include "board.hpp"
+#include "utils.hpp"
+#include <limits>
+#include <array>
+#include <span>
+#include <type_traits>
+#include <cstdint>
+#include <experimental/simd>
+
+namespace reachability::inline REACHABILITY_ISA {
+  // N boards stored as structure of arrays: data[i] holds word i of every board,
+  // so each simd register spans N boards instead of the words of a single one.
+  // predicates (get, contains, any, ...) answer per lane through mask_t.
+  template <unsigned W, unsigned H, std::size_t N, typename under_t=std::uint64_t>
+  struct board_batch_t {
+    using board_type = board_t<W, H, under_t>;
+    using lane_t = std::experimental::simd<under_t, std::experimental::simd_abi::deduce_t<under_t, N>>;
+    using mask_t = typename lane_t::mask_type;
+    static constexpr int under_bits = board_type::under_bits;
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr std::size_t lanes = N;
+    static constexpr int lines_per_under = board_type::lines_per_under;
+    static constexpr int num_of_under = board_type::num_of_under;
+    static constexpr int last = board_type::last;
+    static constexpr under_t mask = board_type::mask;
+    static constexpr under_t last_mask = board_type::last_mask;
+    constexpr board_batch_t() = default;
+    constexpr board_batch_t(std::span<const board_type, N> boards) {
+      for (std::size_t lane = 0; lane < N; ++lane) {
+        set_lane(lane, boards[lane]);
+      }
+    }
+    constexpr void set_lane(std::size_t lane, board_type board) {
+      const auto words = board.to_array();
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        data[i][lane] = words[i];
+      });
+    }
+    constexpr board_type operator[](std::size_t lane) const {
+      std::array<under_t, num_of_under> words;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        words[i] = data[i][lane];
+      });
+      return board_type{words};
+    }
+    template <int x, int y>
+    constexpr void set() {
+      data[y / lines_per_under] |= under_t(1) << ((y % lines_per_under) * W + x);
+    }
+    template <int x, int y>
+    constexpr mask_t get() const {
+      if constexpr ((x < 0) || (x >= int(W)) || (y < 0) || (y >= int(H))) {
+        return mask_t(true);
+      } else {
+        return (data[y / lines_per_under] & (under_t(1) << ((y % lines_per_under) * W + x))) != 0;
+      }
+    }
+    template <int y>
+    constexpr mask_t get() const {
+      // use highest bit as the result
+      return get<W - 1, y>();
+    }
+    constexpr mask_t any() const {
+      mask_t ret(false);
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret = ret || (data[i] != 0);
+      });
+      return ret;
+    }
+    constexpr mask_t operator!=(board_batch_t other) const {
+      return (*this ^ other).any();
+    }
+    constexpr mask_t contains(board_batch_t other) const {
+      mask_t ret(true);
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret = ret && ((other.data[i] & ~data[i]) == 0);
+      });
+      return ret;
+    }
+    static constexpr board_batch_t select(mask_t m, board_batch_t if_true, board_batch_t if_false) {
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        where(m, if_false.data[i]) = if_true.data[i];
+      });
+      return if_false;
+    }
+    constexpr board_batch_t operator~() const {
+      board_batch_t other;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        other.data[i] = word_mask<i>() & ~data[i];
+      });
+      return other;
+    }
+    constexpr board_batch_t &operator&=(board_batch_t rhs) {
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) { data[i] &= rhs.data[i]; });
+      return *this;
+    }
+    constexpr board_batch_t operator&(board_batch_t rhs) const {
+      board_batch_t result = *this;
+      result &= rhs;
+      return result;
+    }
+    constexpr board_batch_t &operator|=(board_batch_t rhs) {
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) { data[i] |= rhs.data[i]; });
+      return *this;
+    }
+    constexpr board_batch_t operator|(board_batch_t rhs) const {
+      board_batch_t result = *this;
+      result |= rhs;
+      return result;
+    }
+    constexpr board_batch_t &operator^=(board_batch_t rhs) {
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) { data[i] ^= rhs.data[i]; });
+      return *this;
+    }
+    constexpr board_batch_t operator^(board_batch_t rhs) const {
+      board_batch_t result = *this;
+      result ^= rhs;
+      return result;
+    }
+    template <coord d, bool check = true>
+    constexpr void move_() {
+      constexpr int dx = d[0_szc], dy = d[1_szc];
+      if constexpr (dy == 0) {
+        static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+          if constexpr (dx > 0) {
+            data[i] = (data[i] << dx) & word_mask<i>();
+          } else if constexpr (dx < 0) {
+            data[i] >>= -dx;
+          }
+        });
+      } else if constexpr (dy > 0) {
+        constexpr int pad = (dy - 1) / lines_per_under;
+        constexpr int shift = (dy - 1) % lines_per_under + 1;
+        auto not_moved = my_split<pad, true>(my_shift<dx, shift>(data));
+        auto moved = my_split<pad+1, true>(my_shift<dx, shift-lines_per_under>(data));
+        static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+          data[i] = (not_moved[i] | moved[i]) & word_mask<i>();
+        });
+      } else {
+        constexpr int pad = (-dy - 1) / lines_per_under;
+        constexpr int shift = (-dy - 1) % lines_per_under + 1;
+        auto not_moved = my_split<pad, false>(my_shift<dx, -shift>(data));
+        auto moved = my_split<pad+1, false>(my_shift<dx, lines_per_under-shift>(data));
+        static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+          data[i] = (not_moved[i] | moved[i]) & word_mask<i>();
+        });
+      }
+      if constexpr (check && dx != 0) {
+        static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+          if constexpr (dx > 0) {
+            data[i] &= columns(dx, W);
+          } else {
+            data[i] &= columns(0, W + dx);
+          }
+        });
+      }
+    }
+    template <coord d, bool check = true>
+    constexpr board_batch_t move() const {
+      board_batch_t result = *this;
+      result.move_<d, check>();
+      return result;
+    }
+    constexpr board_batch_t has_single_bit() const {
+      board_batch_t ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        constexpr under_t low = one_bit<i, 0>(), high = one_bit<i, W - 1>();
+        auto saturated = data[i] | high;
+        saturated &= saturated - low;
+        auto saturated2 = saturated | high;
+        saturated2 &= saturated2 - low;
+        ret.data[i] = (saturated ^ data[i]) & ~saturated2;
+      });
+      return ret;
+    }
+    constexpr board_batch_t all_bits() const {
+      board_batch_t ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        auto low = data[i] & ~one_bit<i, W - 1>();
+        ret.data[i] = data[i] & (low + one_bit<i, 0>());
+      });
+      return ret;
+    }
+    constexpr board_batch_t any_bit() const {
+      return ~(~*this).all_bits();
+    }
+    constexpr board_batch_t no_bit() const {
+      return ~any_bit();
+    }
+    constexpr board_batch_t remove_ones_after_zero() const {
+      // lanewise version of board_t::remove_ones_after_zero:
+      // keep the leading ones of each word until the first word that has a zero
+      board_batch_t ret;
+      mask_t found(false);
+      static_for<num_of_under>([&][[gnu::always_inline]](auto j) {
+        constexpr int i = num_of_under - 1 - j;
+        const lane_t board = data[i] | lane_t(under_t(~word_mask<i>()));
+        lane_t zeros = ~board;
+        static_for<std::bit_width(unsigned(under_bits - 1))>([&][[gnu::always_inline]](auto k) {
+          zeros |= zeros >> (1 << k);
+        });
+        lane_t kept = ~zeros & word_mask<i>();
+        where(found, kept) = lane_t(0);
+        ret.data[i] = kept;
+        found = found || (zeros != 0);
+      });
+      return ret;
+    }
+    constexpr board_batch_t populate_highest_bit() const {
+      board_batch_t ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        constexpr under_t high = one_bit<i, W - 1>();
+        auto result = data[i] & high;
+        auto pre_result = high - (result >> (W - 1));
+        ret.data[i] = pre_result ^ high;
+      });
+      return ret;
+    }
+    constexpr board_batch_t get_heads() const {
+      return (*this) & ~move<coord{-1, 0}>();
+    }
+    friend constexpr board_batch_t can_expand(board_batch_t current, board_batch_t possible) {
+      const auto starts = possible & current.template move<coord{-1, 0}>();
+      const auto ends = possible & current.template move<coord{1, 0}>();
+      const auto all_heads = possible.get_heads();
+      const auto rest = possible & ~all_heads;
+      board_batch_t ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        ret.data[i] = starts.data[i] | (ends.data[i] + rest.data[i]);
+      });
+      return ret;
+    }
+  private:
+    using data_t = std::array<lane_t, num_of_under>;
+    data_t data = {};
+    template <std::size_t i>
+    static constexpr under_t word_mask() {
+      return i == last ? last_mask : mask;
+    }
+    static constexpr under_t columns(int from, int to) {
+      const under_t row = (under_t(1) << to) - (under_t(1) << from);
+      under_t ret = 0;
+      for (int i = 0; i < lines_per_under; ++i) {
+        ret |= row << (i * W);
+      }
+      return ret;
+    }
+    template <std::size_t i, int x>
+    static constexpr under_t one_bit() {
+      return columns(x, x + 1) & word_mask<i>();
+    }
+    template <int removed, bool from_right>
+    static constexpr data_t my_split(const data_t &data) {
+      data_t ret;
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        constexpr size_t index = from_right ? i - removed : i + removed;
+        if constexpr (index >= num_of_under) {
+          ret[i] = 0;
+        } else {
+          ret[i] = data[index];
+        }
+      });
+      return ret;
+    }
+    template <int x_shift, int y_shift>
+    static constexpr data_t my_shift(data_t data) {
+      static_for<num_of_under>([&][[gnu::always_inline]](auto i) {
+        if constexpr (y_shift == lines_per_under || y_shift == -lines_per_under) {
+          data[i] = 0;
+        } else if constexpr (y_shift < 0) {
+          data[i] >>= -y_shift * W;
+        } else if constexpr (y_shift > 0) {
+          data[i] <<= y_shift * W;
+        }
+        if constexpr (x_shift > 0) {
+          data[i] <<= x_shift;
+        } else if constexpr (x_shift < 0) {
+          data[i] >>= -x_shift;
+        }
+      });
+      return data;
+    }
+  };
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "block.hpp"
+#include "hash.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+
+// binary_bfs results remembered by board and piece, for searches that reach the same board again.
+// the table is split into shards with a lock each, a shard into sets of a few entries; a key lives in one set,
+// and a full set gives up the entry chosen by the eviction policy. entries keep the board itself, so a hash
+// collision is a miss and never a wrong result.
+namespace reachability::inline REACHABILITY_ISA::search {
+  enum class eviction {
+    fifo, // the entry stored first
+    lru   // the entry used least recently
+  };
+
+  struct cache_stats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+  };
+
+  template <typename RS, coord start, typename board_t, unsigned init_rot=0, movement model=movement::soft_drop>
+  class reach_cache {
+  public:
+    static constexpr std::size_t ways = 4;
+    // room for at least capacity results
+    explicit reach_cache(std::size_t capacity, eviction policy = eviction::lru, std::size_t shards = 64):
+      policy(policy),
+      shard_count(std::bit_ceil(std::max<std::size_t>(shards, 1))),
+      sets_per_shard(std::bit_ceil(std::max<std::size_t>((capacity + ways - 1) / ways / shard_count, 1))),
+      shard_data(std::make_unique<shard[]>(shard_count)) {
+      for (std::size_t i = 0; i < shard_count; ++i) {
+        shard_data[i].sets = std::make_unique<set[]>(sets_per_shard);
+      }
+    }
+    // binary_bfs<RS, start, init_rot, model>(data, b), from the table if it is there
+    static_vector<board_t, 4> binary_bfs(board_t data, block_type b) {
+      const std::uint64_t key = hash_of(data) ^ reachability::details::mix(std::uint64_t(b) + 1);
+      shard &s = shard_data[key & (shard_count - 1)];
+      set &target = s.sets[(key / shard_count) & (sets_per_shard - 1)];
+      {
+        std::lock_guard lock(s.mutex);
+        const std::uint64_t now = ++s.clock;
+        for (std::size_t i = 0; i < ways; ++i) {
+          if (target.stamps[i] && target.keys[i] == key && target.entries[i].piece == b && !(target.entries[i].board != data)) {
+            if (policy == eviction::lru) {
+              target.stamps[i] = now;
+            }
+            ++s.hits;
+            return result_of(target.entries[i]);
+          }
+        }
+        ++s.misses;
+      }
+      // two threads missing on the same board both store it, the spare copy is evicted in time
+      const auto ret = search::binary_bfs<RS, start, init_rot, model>(data, b);
+      std::lock_guard lock(s.mutex);
+      std::size_t victim = 0;
+      for (std::size_t i = 1; i < ways; ++i) {
+        if (target.stamps[i] < target.stamps[victim]) {
+          victim = i;
+        }
+      }
+      s.evictions += target.stamps[victim] != 0;
+      entry &e = target.entries[victim];
+      e.board = data;
+      e.piece = b;
+      e.shapes = ret.size();
+      for (std::size_t i = 0; i < ret.size(); ++i) {
+        e.result[i] = ret[i];
+      }
+      target.keys[victim] = key;
+      target.stamps[victim] = ++s.clock;
+      return ret;
+    }
+    cache_stats stats() const {
+      cache_stats ret = {};
+      for (std::size_t i = 0; i < shard_count; ++i) {
+        std::lock_guard lock(shard_data[i].mutex);
+        ret.hits += shard_data[i].hits;
+        ret.misses += shard_data[i].misses;
+        ret.evictions += shard_data[i].evictions;
+      }
+      return ret;
+    }
+    void clear() {
+      for (std::size_t i = 0; i < shard_count; ++i) {
+        std::lock_guard lock(shard_data[i].mutex);
+        for (std::size_t j = 0; j < sets_per_shard; ++j) {
+          shard_data[i].sets[j].stamps = {};
+        }
+        shard_data[i].hits = shard_data[i].misses = shard_data[i].evictions = 0;
+      }
+    }
+  private:
+    struct entry {
+      board_t board;
+      std::array<board_t, 4> result; // only the first shapes are used
+      block_type piece;
+      std::uint8_t shapes;
+    };
+    // keys and stamps share one cache line, so a miss reads no entry unless the key matches
+    struct alignas(64) set {
+      std::array<std::uint64_t, ways> keys;
+      std::array<std::uint64_t, ways> stamps = {}; // 0 for an empty entry
+      std::array<entry, ways> entries;
+    };
+    struct alignas(64) shard {
+      mutable std::mutex mutex;
+      std::unique_ptr<set[]> sets;
+      std::uint64_t clock = 0;
+      std::uint64_t hits = 0, misses = 0, evictions = 0;
+    };
+    static static_vector<board_t, 4> result_of(const entry &e) {
+      auto result = e.result;
+      return static_vector<board_t, 4>{std::span{result.data(), e.shapes}};
+    }
+    eviction policy;
+    std::size_t shard_count;
+    std::size_t sets_per_shard;
+    std::unique_ptr<shard[]> shard_data;
+  };
+}
@@ -0,0 +1,343 @@
+#pragma once
+#include "block.hpp"
+#include "board.hpp"
+#include "utils.hpp"
+#include <limits>
+#include <string>
+#include <string_view>
+#include <array>
+#include <type_traits>
+#include <cstdint>
+#include <bit>
+#include <functional>
+#include <span>
+#include <experimental/simd>
+
+namespace reachability::inline REACHABILITY_ISA {
+  template <unsigned H>
+  using column_under_t =
+    std::conditional_t<(H <= 16), std::uint16_t,
+    std::conditional_t<(H <= 32), std::uint32_t, std::uint64_t>>;
+
+  // column-major counterpart of board_t: one under_t per column, bit y of a word is row y.
+  // vertical moves are plain shifts inside each word and horizontal moves are lane permutations.
+  // like board_t, row-wise results (has_single_bit, all_bits, ...) are stored in the highest column.
+  template <unsigned W, unsigned H, typename under_t=column_under_t<H>>
+    requires
+      std::numeric_limits<under_t>::is_integer
+      && std::is_unsigned_v<under_t>
+      && (std::numeric_limits<under_t>::digits >= H)
+  struct column_board_t {
+    static constexpr int under_bits = std::numeric_limits<under_t>::digits;
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int num_of_under = W;
+    static constexpr int lanes = std::bit_ceil(W);
+    static constexpr under_t mask = under_t(-1) >> (under_bits - H);
+    constexpr column_board_t() = default;
+    constexpr column_board_t(std::string_view s): column_board_t(convert_to_array(s)) {}
+    constexpr column_board_t(std::array<under_t, W> d): data([&](auto i) {
+      if constexpr (i < W) {
+        return d[i];
+      } else {
+        return under_t(0);
+      }
+    }) {}
+    template <typename other_under_t>
+    explicit constexpr column_board_t(board_t<W, H, other_under_t> board) {
+      static_for<H>([&][[gnu::always_inline]](auto y) {
+        static_for<W>([&][[gnu::always_inline]](auto x) {
+          if (board.template get<x, y>()) set<x, y>();
+        });
+      });
+    }
+    static constexpr std::array<under_t, W> convert_to_array(std::string_view s) {
+      // same string layout as board_t: the last character is the lowest bit of the lowest row
+      std::array<under_t, W> data = {};
+      for (std::size_t i = 0; i < W * H; ++i) {
+        if (s[W * H - 1 - i] == 'X')
+          data[i % W] |= under_t(1) << (i / W);
+      }
+      return data;
+    }
+    constexpr std::array<under_t, W> to_array() const {
+      std::array<under_t, W> ret;
+      static_for<W>([&][[gnu::always_inline]](auto i) {
+        ret[i] = data[i];
+      });
+      return ret;
+    }
+    template <typename other_under_t=std::uint64_t>
+    constexpr board_t<W, H, other_under_t> to_row_major() const {
+      board_t<W, H, other_under_t> board;
+      static_for<H>([&][[gnu::always_inline]](auto y) {
+        static_for<W>([&][[gnu::always_inline]](auto x) {
+          if (get<x, y>()) board.template set<x, y>();
+        });
+      });
+      return board;
+    }
+    template <int x, int y>
+    constexpr void set() {
+      data[x] |= under_t(1) << y;
+    }
+    constexpr void set(int x, int y) {
+      data[x] |= under_t(1) << y;
+    }
+    template <int x, int y>
+    constexpr int get() const {
+      if ((x < 0) || (x >= W) || (y < 0) || (y >= H)) {
+        return 2;
+      }
+      return data[x] & (under_t(1) << y) ? 1 : 0;
+    }
+    constexpr int get(int x, int y) const {
+      if ((x < 0) || (x >= int(W)) || (y < 0) || (y >= int(H))) {
+        return 2;
+      }
+      return data[x] & (under_t(1) << y) ? 1 : 0;
+    }
+    template <int y>
+    constexpr int get() const {
+      // use highest column as the result
+      return get<W - 1, y>();
+    }
+    constexpr bool any() const {
+      return *this != column_board_t{};
+    }
+    constexpr bool operator!=(column_board_t other) const {
+      return any_of(data != other.data);
+    }
+    constexpr bool contains(column_board_t other) const {
+      return all_of((other.data & ~data) == 0);
+    }
+    constexpr column_board_t operator~() const {
+      return to_board(mask_board() & ~data);
+    }
+    constexpr column_board_t &operator&=(column_board_t rhs) {
+      data &= rhs.data;
+      return *this;
+    }
+    constexpr column_board_t operator&(column_board_t rhs) const {
+      column_board_t result = *this;
+      result &= rhs;
+      return result;
+    }
+    constexpr column_board_t &operator|=(column_board_t rhs) {
+      data |= rhs.data;
+      return *this;
+    }
+    constexpr column_board_t operator|(column_board_t rhs) const {
+      column_board_t result = *this;
+      result |= rhs;
+      return result;
+    }
+    constexpr column_board_t &operator^=(column_board_t rhs) {
+      data ^= rhs.data;
+      return *this;
+    }
+    constexpr column_board_t operator^(column_board_t rhs) const {
+      column_board_t result = *this;
+      result ^= rhs;
+      return result;
+    }
+    template <Wrap<mino_p> auto mino>
+    static constexpr column_board_t put(int x, int y) {
+      column_board_t shape;
+      static_for<std::tuple_size_v<decltype(mino)>>([&][[gnu::always_inline]](auto i) {
+        constexpr int dx = mino[i][0_szc], dy = mino[i][1_szc];
+        shape.data[x + dx] |= under_t(1) << (y + dy);
+      });
+      shape.data &= mask_board();
+      return shape;
+    }
+    template <coord d, bool check = true>
+    constexpr void move_() {
+      // columns never wrap into each other, so check is not needed
+      constexpr int dx = d[0_szc], dy = d[1_szc];
+      if constexpr (dx != 0) {
+        data = data_t([&][[gnu::always_inline]](auto i) {
+          constexpr int from = int(i) - dx;
+          if constexpr (i >= W || from < 0 || from >= int(W)) {
+            return under_t(0);
+          } else {
+            return under_t(data[from]);
+          }
+        });
+      }
+      if constexpr (dy >= int(H) || -dy >= int(H)) {
+        data = 0;
+      } else if constexpr (dy > 0) {
+        data <<= dy;
+        data &= mask_board();
+      } else if constexpr (dy < 0) {
+        data >>= -dy;
+      }
+    }
+    template <coord d, bool check = true>
+    constexpr column_board_t move() const {
+      column_board_t result = *this;
+      result.move_<d, check>();
+      return result;
+    }
+    constexpr column_board_t move(int dx, int dy) const {
+      // runtime counterpart of move<coord{dx, dy}>()
+      if (dx >= int(W) || -dx >= int(W) || dy >= int(H) || -dy >= int(H)) {
+        return {};
+      }
+      const auto columns = to_array();
+      return to_board(data_t([&][[gnu::always_inline]](auto i) {
+        const int from = int(i) - dx;
+        if (i >= W || from < 0 || from >= int(W)) {
+          return under_t(0);
+        }
+        return under_t((dy >= 0 ? columns[from] << dy : columns[from] >> -dy) & mask);
+      }));
+    }
+    friend constexpr std::string to_string(column_board_t board) {
+      return to_string(board.to_row_major());
+    }
+    friend constexpr std::string to_string(column_board_t board1, column_board_t board2) {
+      return to_string(board1.to_row_major(), board2.to_row_major());
+    }
+    friend constexpr std::string to_string(column_board_t board1, column_board_t board2, column_board_t board_3) {
+      return to_string(board1.to_row_major(), board2.to_row_major(), board_3.to_row_major());
+    }
+    constexpr std::uint64_t full_rows() const {
+      // bit y of the result is set iff line y is full
+      return std::experimental::reduce(data | ~mask_board(), std::bit_and<>{}) & mask;
+    }
+    static constexpr column_board_t lines(std::uint64_t rows) {
+      // bit y of rows fills line y
+      return to_board(mask_board() & data_t(under_t(rows)));
+    }
+    constexpr column_board_t remove_lines(std::uint64_t rows) const {
+#ifdef __BMI2__
+      const under_t kept = under_t(~rows) & mask;
+      return to_board(data_t([&][[gnu::always_inline]](auto i) {
+        return under_t(_pext_u64(data[i], kept));
+      }));
+#else
+      auto copied = data;
+      // remove from the highest line so lower indices stay valid
+      for (under_t removed = under_t(rows) & mask; removed; ) {
+        const int y = std::bit_width(removed) - 1;
+        const under_t below = (under_t(1) << y) - 1;
+        copied = (copied & below) | ((copied >> 1) & ~below);
+        removed &= below;
+      }
+      return to_board(copied);
+#endif
+    }
+    constexpr clear_result<column_board_t> clear_full_lines() const {
+      const auto rows = full_rows();
+      return {remove_lines(rows), std::popcount(rows), rows};
+    }
+    constexpr column_board_t has_single_bit() const {
+      under_t once = 0, twice = 0;
+      static_for<W>([&][[gnu::always_inline]](auto i) {
+        twice |= once & data[i];
+        once |= data[i];
+      });
+      return highest_column(once & ~twice);
+    }
+    constexpr column_board_t all_bits() const {
+      return highest_column(under_t(full_rows()));
+    }
+    constexpr column_board_t any_bit() const {
+      return ~(~*this).all_bits();
+    }
+    constexpr column_board_t no_bit() const {
+      return ~any_bit();
+    }
+    constexpr column_board_t remove_ones_after_zero() const {
+      // same order as board_t: from the top row down, and from the highest column down inside a row
+      under_t zeros = under_t(~(under_t(full_rows()) | ~mask));
+      static_for<std::bit_width(unsigned(under_bits - 1))>([&][[gnu::always_inline]](auto k) {
+        zeros |= zeros >> (1 << k);
+      });
+      const under_t kept_rows = under_t(~zeros) & mask;
+      under_t partial = zeros ^ (zeros >> 1);
+      data_t result = 0;
+      static_for<W>([&][[gnu::always_inline]](auto j) {
+        constexpr int i = W - 1 - j;
+        partial &= data[i];
+        result[i] = kept_rows | partial;
+      });
+      return to_board(result);
+    }
+    constexpr column_board_t populate_highest_bit() const {
+      // result is in highest column (0 or 1), other columns are 0
+      // populate the result to all columns
+      return to_board(mask_board() & data_t(under_t(data[W - 1])));
+    }
+    constexpr column_board_t get_heads() const {
+      return (*this) & ~move<coord{-1, 0}>();
+    }
+    friend constexpr column_board_t can_expand(column_board_t current, column_board_t possible) {
+      // the head (highest column) of every run in possible is set iff the run touches current
+      auto reached = possible & (current.template move<coord{-1, 0}>() | current.template move<coord{1, 0}>());
+      auto run = possible;
+      static_for<std::bit_width(unsigned(W - 1))>([&][[gnu::always_inline]](auto k) {
+        constexpr int step = 1 << k;
+        reached |= run & reached.template move<coord{step, 0}>();
+        run &= run.template move<coord{step, 0}>();
+      });
+      return reached;
+    }
+    constexpr int count() const {
+      int ret = 0;
+      static_for<W>([&][[gnu::always_inline]](auto i) {
+        ret += std::popcount(under_t(data[i]));
+      });
+      return ret;
+    }
+    // write the position of every set bit to out, which must hold count() entries
+    std::size_t extract(std::span<coord> out) const {
+      std::size_t n = 0;
+      static_for<W>([&][[gnu::always_inline]](auto i) {
+        std::array<std::uint8_t, 64> indices;
+        const std::size_t found = details::bit_indices(data[i], indices.data());
+        for (std::size_t j = 0; j < found; ++j) {
+          out[n + j] = coord{int(i), indices[j]};
+        }
+        n += found;
+      });
+      return n;
+    }
+    template <class F>
+    void for_each_bit(F &&f) const {
+      reachability::static_for<W>([&][[gnu::always_inline]](auto i) {
+        for (under_t data_i = data[i]; data_i; data_i &= data_i - 1) {
+          f(int(i), std::countr_zero(data_i));
+        }
+      });
+    }
+  private:
+    using data_t = std::experimental::simd<under_t, std::experimental::simd_abi::deduce_t<under_t, lanes>>;
+    data_t data = 0;
+    static constexpr column_board_t to_board(data_t data) {
+      column_board_t ret;
+      ret.data = data;
+      return ret;
+    }
+    static constexpr data_t mask_board() {
+      return data_t{[](auto i) {
+        if constexpr (i < W) {
+          return mask;
+        } else {
+          return under_t(0);
+        }
+      }};
+    }
+    static constexpr column_board_t highest_column(under_t rows) {
+      return to_board(data_t{[=](auto i) {
+        if constexpr (i == W - 1) {
+          return rows;
+        } else {
+          return under_t(0);
+        }
+      }});
+    }
+  };
+}
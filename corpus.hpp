@@ -0,0 +1,200 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// binary corpus of boards and of binary_bfs results
+// a file is a header followed by fixed-size records in native byte order,
+// board words are stored exactly as board_t::to_array returns them so nothing is parsed per board
+namespace reachability::inline REACHABILITY_ISA::corpus {
+  struct header {
+    char magic[4];
+    std::uint16_t width;
+    std::uint16_t height;
+    std::uint16_t under_bits;
+    std::uint16_t num_of_under;
+    std::uint32_t record_size;
+    std::uint64_t count;
+    std::uint64_t reserved;
+  };
+  static_assert(sizeof(header) == 32);
+  inline constexpr char board_magic[4] = {'R', 'B', 'C', '1'};
+  inline constexpr char result_magic[4] = {'R', 'B', 'R', '1'};
+
+  template <typename board_t>
+  using words_t = decltype(std::declval<board_t>().to_array());
+
+  template <typename board_t>
+  struct board_record {
+    words_t<board_t> words;
+    std::uint8_t piece; // block_type
+    std::uint8_t rotation;
+    std::int8_t spawn_x;
+    std::int8_t spawn_y;
+    constexpr board_t board() const {
+      return board_t{words};
+    }
+  };
+
+  template <typename board_t>
+  struct result_record {
+    std::array<words_t<board_t>, 4> shapes; // landable positions of each shape, in the same layout as the boards
+    std::uint8_t piece;
+    std::uint8_t count; // number of used entries in shapes
+  };
+
+  class mapped_file {
+  public:
+    mapped_file() = default;
+    // map an existing file read-only
+    explicit mapped_file(const std::string &path) {
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+      struct stat st;
+      if (::fstat(fd, &st) < 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "fstat " + path);
+      }
+      size_ = st.st_size;
+      map(fd, PROT_READ, path);
+      ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    // create (or truncate) a file of the given size and map it writable
+    mapped_file(const std::string &path, std::size_t size): size_(size) {
+      const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+      if (::ftruncate(fd, size) < 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "ftruncate " + path);
+      }
+      map(fd, PROT_READ | PROT_WRITE, path);
+    }
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+    mapped_file &operator=(mapped_file &&other) noexcept {
+      std::swap(data_, other.data_);
+      std::swap(size_, other.size_);
+      return *this;
+    }
+    ~mapped_file() {
+      if (data_) ::munmap(data_, size_);
+    }
+    std::byte *data() const { return static_cast<std::byte *>(data_); }
+    std::size_t size() const { return size_; }
+  private:
+    void *data_ = nullptr;
+    std::size_t size_ = 0;
+    void map(int fd, int prot, const std::string &path) {
+      data_ = size_ ? ::mmap(nullptr, size_, prot, MAP_SHARED, fd, 0) : nullptr;
+      const int err = errno;
+      ::close(fd);
+      if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::system_error(err, std::generic_category(), "mmap " + path);
+      }
+    }
+  };
+
+  template <typename board_t, typename record_t>
+  constexpr header make_header(const char (&magic)[4], std::uint64_t count) {
+    header h = {};
+    std::memcpy(h.magic, magic, sizeof(h.magic));
+    h.width = board_t::width;
+    h.height = board_t::height;
+    h.under_bits = board_t::under_bits;
+    h.num_of_under = board_t::num_of_under;
+    h.record_size = sizeof(record_t);
+    h.count = count;
+    return h;
+  }
+
+  // read-only view of a corpus file, records are used in place
+  template <typename board_t, typename record_t=board_record<board_t>>
+  class reader {
+  public:
+    explicit reader(const std::string &path, const char (&magic)[4]=board_magic): file(path) {
+      if (file.size() < sizeof(header)) throw std::runtime_error(path + ": not a corpus file");
+      header h;
+      std::memcpy(&h, file.data(), sizeof(h));
+      const auto expected = make_header<board_t, record_t>(magic, h.count);
+      if (std::memcmp(&h, &expected, sizeof(h)) != 0) throw std::runtime_error(path + ": corpus does not match the board geometry");
+      if (file.size() < sizeof(header) + h.count * sizeof(record_t)) throw std::runtime_error(path + ": truncated corpus");
+      records_ = {reinterpret_cast<const record_t *>(file.data() + sizeof(header)), h.count};
+    }
+    std::span<const record_t> records() const { return records_; }
+    std::size_t size() const { return records_.size(); }
+    template <typename F>
+    void for_each_batch(std::size_t batch, F &&f) const {
+      for (std::size_t i = 0; i < records_.size(); i += batch) {
+        f(i, records_.subspan(i, std::min(batch, records_.size() - i)));
+      }
+    }
+  private:
+    mapped_file file;
+    std::span<const record_t> records_;
+  };
+
+  // a corpus file of a known number of records, written in place through the mapping
+  template <typename board_t, typename record_t=board_record<board_t>>
+  class writer {
+  public:
+    writer(const std::string &path, std::size_t count, const char (&magic)[4]=board_magic):
+      file(path, sizeof(header) + count * sizeof(record_t)) {
+      const auto h = make_header<board_t, record_t>(magic, count);
+      std::memcpy(file.data(), &h, sizeof(h));
+      records_ = {reinterpret_cast<record_t *>(file.data() + sizeof(header)), count};
+    }
+    std::span<record_t> records() const { return records_; }
+    record_t &operator[](std::size_t i) const { return records_[i]; }
+  private:
+    mapped_file file;
+    std::span<record_t> records_;
+  };
+
+  template <typename board_t>
+  struct result_reader: reader<board_t, result_record<board_t>> {
+    explicit result_reader(const std::string &path): reader<board_t, result_record<board_t>>(path, result_magic) {}
+  };
+  template <typename board_t>
+  struct result_writer: writer<board_t, result_record<board_t>> {
+    result_writer(const std::string &path, std::size_t count): writer<board_t, result_record<board_t>>(path, count, result_magic) {}
+  };
+
+  // run binary_bfs on every record of input and store the landable positions in output (same record order)
+  // the spawn and rotation of each record are dispatched at runtime (pieces with fewer orientations wrap around),
+  // records spawning at start use its specialized kernels, any other spawn runs the runtime seeded kernel
+  template <typename RS, coord start, typename board_t>
+  void reach(const reader<board_t> &input, const result_writer<board_t> &output, std::size_t batch=4096) {
+    using spawns = search::spawn_range<start[0_szc], start[0_szc], start[1_szc], start[1_szc]>;
+    input.for_each_batch(batch, [&](std::size_t offset, std::span<const board_record<board_t>> records) {
+      for (std::size_t i = 0; i < records.size(); ++i) {
+        const auto &record = records[i];
+        if (record.rotation >= 4) [[unlikely]] {
+          throw std::runtime_error("corpus: invalid rotation");
+        }
+        auto &result = output[offset + i];
+        const auto shapes = search::binary_bfs<RS, spawns>(record.board(), block_type(record.piece), coord{record.spawn_x, record.spawn_y}, record.rotation);
+        result.piece = record.piece;
+        result.count = shapes.size();
+        for (std::size_t j = 0; j < shapes.size(); ++j) {
+          result.shapes[j] = shapes[j].to_array();
+        }
+      }
+    });
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "utils.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+// one binary for hosts of different instruction sets. isa/kernels.cpp is compiled once per level with the -march of
+// the level and -DREACHABILITY_ISA=<level>, so every copy of the library sits in its own inline namespace, with the
+// word type and simd width of its level, and the best level that is linked in and that cpuid reports is used.
+// boards cross as one bit mask per row like in registry.hpp, the piece and the spawn as plain integers since every
+// level has its own block_type and coord
+namespace reachability::dispatch {
+  enum class level {
+    sse4_2, // x86-64-v2
+    avx2,   // x86-64-v3
+    avx512  // x86-64-v4
+  };
+  inline constexpr int levels = 3;
+  inline constexpr std::array<std::string_view, levels> level_names = {"sse4_2", "avx2", "avx512"};
+
+  // binary_bfs of one geometry
+  struct kernel {
+    int width;
+    int height;
+    // landable positions of piece (a block_type) as rows, shape s at out[s * height, (s + 1) * height)
+    // rows must hold height entries and out 4 * height entries, returns the number of shapes
+    int (*binary_bfs)(const std::uint64_t *rows, int piece, int x, int y, unsigned init_rot, std::uint64_t *out);
+  };
+  // the kernels of one level, for the geometries of default_registry
+  struct variant {
+    level isa;
+    int under_bits; // the words boards are stored in
+    int simd_bits;  // the native simd register
+    std::array<kernel, 3> kernels;
+    constexpr const kernel *find(int width, int height) const {
+      for (const auto &k : kernels) {
+        if (k.width == width && k.height == height) {
+          return &k;
+        }
+      }
+      return nullptr;
+    }
+  };
+
+  // defined by the objects of isa/kernels.cpp; weak, so a binary links only the levels it wants
+  namespace variants {
+    [[gnu::weak]] extern const variant sse4_2;
+    [[gnu::weak]] extern const variant avx2;
+    [[gnu::weak]] extern const variant avx512;
+  }
+
+  // compiled for the level of the including file, like the rest of the library, so that the copy in a kernel object
+  // never stands in for the one the caller was built for
+  inline namespace REACHABILITY_ISA {
+    // whether the cpu (and the os, for the wider registers) can run the level
+    inline bool supported(level isa) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_cpu_init();
+      switch (isa) {
+        case level::sse4_2:
+          return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case level::avx2:
+          return supported(level::sse4_2) && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")
+            && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma");
+        case level::avx512:
+          return supported(level::avx2) && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+        default: std::unreachable();
+      }
+#else
+      return false;
+#endif
+    }
+    // the levels linked in, lowest first, nullptr for the missing ones
+    inline std::array<const variant *, levels> linked() {
+      return {&variants::sse4_2, &variants::avx2, &variants::avx512};
+    }
+    // the levels linked in that this cpu runs, lowest first
+    inline static_vector<const variant *, levels> available() {
+      std::array<const variant *, levels> found;
+      std::size_t n = 0;
+      for (const auto *v : linked()) {
+        if (v && supported(v->isa)) {
+          found[n++] = v;
+        }
+      }
+      return std::span<const variant *>{found.data(), n};
+    }
+    // the highest available level, looked up once
+    inline const variant &best() {
+      static const variant *const chosen = []{
+        const auto found = available();
+        if (found.size() == 0) {
+          throw std::runtime_error("dispatch: no kernels for this cpu are linked in");
+        }
+        return found[found.size() - 1];
+      }();
+      return *chosen;
+    }
+  }
+}
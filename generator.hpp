@@ -0,0 +1,249 @@
+#pragma once
+#include "block.hpp"
+#include "corpus.hpp"
+#include "successor.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// seeded boards that look like play, for checking and timing binary_bfs on more than a handful of samples
+// the same seed gives the same boards everywhere: mt19937_64 is fully specified and every draw is done here
+namespace reachability::inline REACHABILITY_ISA::corpus {
+  enum class board_class {
+    play,    // stacks of a game placing pieces with a noisy height and holes heuristic
+    garbage, // rows of garbage with one or two holes each, with a few pieces on top
+    spin,    // T-spin double and triple slots under a roof
+    cave     // a tall stack with tunnels walked through it
+  };
+  inline constexpr std::array board_classes = {board_class::play, board_class::garbage, board_class::spin, board_class::cave};
+  constexpr std::string_view name_of(board_class c) {
+    using enum board_class;
+    switch (c) {
+      case play: return "play";
+      case garbage: return "garbage";
+      case spin: return "spin";
+      case cave: return "cave";
+      default: std::unreachable();
+    }
+  }
+
+  // boards of one class, spawning pieces at start; every stack stays a few lines below the spawn
+  template <typename RS, coord start, typename board_t>
+  class generator {
+  public:
+    static constexpr int W = board_t::width;
+    static constexpr int H = board_t::height;
+    // the highest line a stack may reach
+    static constexpr int ceiling = std::min(H, start[1_szc]) - 4;
+    static_assert(ceiling >= 8, "the spawn is too low for the generated stacks");
+
+    generator(board_class kind, std::uint64_t seed): kind(kind), rng(seed), successors(4 * W * H) {}
+    board_t next() {
+      using enum board_class;
+      switch (kind) {
+        case play: return next_play();
+        case garbage: return next_garbage();
+        case spin: return next_spin();
+        case cave: return next_cave();
+        default: std::unreachable();
+      }
+    }
+    // a board with a random piece spawning at start
+    board_record<board_t> next_record() {
+      board_record<board_t> record;
+      record.words = next().to_array();
+      record.piece = below(7);
+      record.rotation = 0;
+      record.spawn_x = start[0_szc];
+      record.spawn_y = start[1_szc];
+      return record;
+    }
+
+  private:
+    board_class kind;
+    std::mt19937_64 rng;
+    std::vector<search::successor<board_t>> successors;
+    board_t game;
+    int height_weight = 0;
+
+    // uniform in [0, n), by the high half of a 128-bit product
+    int below(int n) {
+      return int((unsigned __int128)rng() * unsigned(n) >> 64);
+    }
+    bool chance(int percent) {
+      return below(100) < percent;
+    }
+    static int stack_height(board_t data) {
+      for (int y = H - 1; y >= 0; --y) {
+        for (int x = 0; x < W; ++x) {
+          if (data.get(x, y)) {
+            return y + 1;
+          }
+        }
+      }
+      return 0;
+    }
+    static board_t cell(int x, int y) {
+      board_t ret;
+      ret.set(x, y);
+      return ret;
+    }
+    // lines [from, to) filled except where holes is set
+    static board_t rows(int from, int to, board_t holes={}) {
+      board_t ret;
+      for (int y = from; y < to; ++y) {
+        for (int x = 0; x < W; ++x) {
+          ret.set(x, y);
+        }
+      }
+      return ret & ~holes;
+    }
+    // lower is better: the sum of the column heights (weighted per game), holes and the roughness of the surface
+    int score(board_t data) {
+      int sum = 0, holes = 0, bumps = 0, previous = -1;
+      for (int x = 0; x < W; ++x) {
+        int top = 0;
+        for (int y = 0; y < H; ++y) {
+          if (data.get(x, y)) {
+            top = y + 1;
+          }
+        }
+        for (int y = 0; y < top; ++y) {
+          holes += !data.get(x, y);
+        }
+        sum += top;
+        bumps += previous < 0 ? 0 : std::abs(top - previous);
+        previous = top;
+      }
+      return height_weight * sum + 8 * holes + 2 * bumps + below(12);
+    }
+    // place a random piece on data by the heuristic; false if it has nowhere to go below the ceiling
+    bool place(board_t &data) {
+      const auto b = block_type(below(7));
+      const auto n = search::generate_successors<RS, start>(data, b, std::span{successors});
+      int best = -1, best_score = 0;
+      for (int i = 0; i < int(std::min(n, successors.size())); ++i) {
+        if (stack_height(successors[i].board) > ceiling) {
+          continue;
+        }
+        const int s = score(successors[i].board);
+        if (best < 0 || s < best_score) {
+          best = i;
+          best_score = s;
+        }
+      }
+      if (best < 0) {
+        return false;
+      }
+      data = successors[best].board;
+      return true;
+    }
+    void place(board_t &data, int count) {
+      for (int i = 0; i < count && place(data); ++i) {
+      }
+    }
+
+    // one placement of a game per board, a new game on top-out; half of the games do not mind their height
+    board_t next_play() {
+      if (!place(game)) {
+        game = {};
+        height_weight = below(2);
+        place(game);
+      }
+      return game;
+    }
+    // garbage that mostly keeps its hole column, now and then with a second hole
+    board_t next_garbage() {
+      const int lines = 2 + below(ceiling / 2);
+      board_t holes;
+      int column = below(W);
+      for (int y = lines - 1; y >= 0; --y) {
+        if (chance(30)) {
+          column = below(W);
+        }
+        holes.set(column, y);
+        if (chance(15)) {
+          holes.set(below(W), y);
+        }
+      }
+      board_t data = rows(0, lines, holes);
+      place(data, below(6));
+      return data;
+    }
+    // a slot at column c over garbage: a T-spin double (three wide under a roof on one side) or a
+    // T-spin triple (a column of three with a notch, the roof over the column)
+    board_t next_spin() {
+      const int base = below(5);
+      board_t holes;
+      for (int y = 0; y < base; ++y) {
+        holes.set(below(W), y);
+      }
+      const int c = 1 + below(W - 2);
+      const int d = chance(50) ? 1 : -1;
+      // line y from the wall on the other side of d up to column to
+      const auto roof = [&](int y, int to) {
+        board_t ret;
+        for (int x = d > 0 ? 0 : to; x <= (d > 0 ? to : W - 1); ++x) {
+          ret.set(x, y);
+        }
+        return ret;
+      };
+      board_t data;
+      if (chance(60)) {
+        holes |= cell(c, base) | cell(c - 1, base + 1) | cell(c, base + 1) | cell(c + 1, base + 1);
+        data = rows(0, base + 2, holes) | roof(base + 2, c - d);
+      } else {
+        // the roof covers the column and leaves the notch side open
+        holes |= cell(c, base) | cell(c, base + 1) | cell(c + d, base + 1) | cell(c, base + 2);
+        data = rows(0, base + 3, holes) | roof(base + 3, c);
+      }
+      place(data, below(3));
+      return data.clear_full_lines().board;
+    }
+    // a stack with a few tunnels that start at its surface and wander down and sideways, sometimes two wide
+    board_t next_cave() {
+      const int lines = ceiling / 2 + below(ceiling / 2 + 1);
+      // a hole in every line, or the lines the tunnels miss would be cleared
+      board_t holes;
+      for (int y = 0; y < lines; ++y) {
+        holes.set(below(W), y);
+      }
+      board_t data = rows(0, lines, holes);
+      const int tunnels = 2 + below(4);
+      for (int t = 0; t < tunnels; ++t) {
+        int x = below(W), y = lines - 1;
+        const int length = 6 + below(18);
+        const bool wide = chance(40);
+        for (int i = 0; i < length; ++i) {
+          data &= ~cell(x, y);
+          if (wide && x + 1 < W) {
+            data &= ~cell(x + 1, y);
+          }
+          switch (below(7)) {
+            case 0: case 1: x = std::max(x - 1, 0); break;
+            case 2: case 3: x = std::min(x + 1, W - 1); break;
+            case 4: case 5: y = std::max(y - 1, 0); break;
+            default: y = std::min(y + 1, lines - 1); break;
+          }
+        }
+      }
+      return data.clear_full_lines().board;
+    }
+  };
+
+  // write count records of one class to path
+  template <typename RS, coord start, typename board_t>
+  void generate(const std::string &path, board_class kind, std::uint64_t seed, std::size_t count) {
+    generator<RS, start, board_t> g(kind, seed);
+    writer<board_t> out(path, count);
+    for (std::size_t i = 0; i < count; ++i) {
+      out[i] = g.next_record();
+    }
+  }
+}
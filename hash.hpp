@@ -0,0 +1,125 @@
+#pragma once
+#include "block.hpp"
+#include "board.hpp"
+#include "column_board.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace reachability::inline REACHABILITY_ISA {
+  namespace details {
+    // finalizer of murmur3, a bijection on 64 bits
+    constexpr std::uint64_t mix(std::uint64_t x) {
+      x ^= x >> 33;
+      x *= 0xff51afd7ed558ccdull;
+      x ^= x >> 33;
+      x *= 0xc4ceb9fe1a85ec53ull;
+      x ^= x >> 33;
+      return x;
+    }
+    constexpr std::uint64_t hash_word(std::uint64_t word, std::size_t i) {
+      return mix(word ^ mix(0x9e3779b97f4a7c15ull * (i + 1)));
+    }
+  }
+
+  // every under_t word is hashed on its own with a per-index key and the results are xor-ed,
+  // so a child board only has to rehash the words that differ from its parent
+  template <typename board_t>
+  constexpr std::uint64_t hash_of(board_t board) {
+    const auto words = board.to_array();
+    std::uint64_t ret = 0;
+    static_for<std::tuple_size_v<decltype(words)>>([&][[gnu::always_inline]](auto i) {
+      ret ^= details::hash_word(words[i], i);
+    });
+    return ret;
+  }
+
+  // put<mino>(x, y) followed by clear_full_lines, with the hash of the result derived from parent_hash:
+  // only the words covered by the piece are rehashed, plus every word from the lowest cleared line up
+  template <Wrap<mino_p> auto mino, unsigned W, unsigned H, typename under_t>
+  constexpr std::pair<clear_result<board_t<W, H, under_t>>, std::uint64_t>
+  lock_and_hash(board_t<W, H, under_t> board, std::uint64_t parent_hash, int x, int y) {
+    using board_type = board_t<W, H, under_t>;
+    constexpr auto range = blocks::mino_range<mino>();
+    constexpr int lines_per_under = board_type::lines_per_under;
+    std::uint64_t hash = parent_hash;
+    const auto before = board.to_array();
+    const board_type locked = board | board_type::template put<mino>(x, y);
+    const auto after = locked.to_array();
+    const int top = std::min((y + range[3]) / lines_per_under, board_type::last);
+    for (int i = std::max(y + range[1], 0) / lines_per_under; i <= top; ++i) {
+      hash ^= details::hash_word(before[i], i) ^ details::hash_word(after[i], i);
+    }
+    const auto rows = locked.full_rows();
+    if (!rows) [[likely]] {
+      return {{locked, 0, 0}, hash};
+    }
+    const board_type cleared = locked.remove_lines(rows);
+    const auto result = cleared.to_array();
+    for (int i = std::countr_zero(rows) / lines_per_under; i < board_type::num_of_under; ++i) {
+      hash ^= details::hash_word(after[i], i) ^ details::hash_word(result[i], i);
+    }
+    return {{cleared, std::popcount(rows), rows}, hash};
+  }
+
+  template <typename board_t>
+  struct hashed_board {
+    board_t board;
+    std::uint64_t hash;
+    constexpr hashed_board(board_t board): board(board), hash(hash_of(board)) {}
+    constexpr hashed_board(board_t board, std::uint64_t hash): board(board), hash(hash) {}
+  };
+
+  // transparent hash and equality: tables keyed by board_t can be probed with a hashed_board
+  // whose hash was already computed incrementally, and vice versa
+  struct board_hash {
+    using is_transparent = void;
+    template <typename board_t>
+    constexpr std::size_t operator()(const board_t &board) const {
+      return hash_of(board);
+    }
+    template <typename board_t>
+    constexpr std::size_t operator()(const hashed_board<board_t> &board) const {
+      return board.hash;
+    }
+  };
+  struct board_equal {
+    using is_transparent = void;
+    template <typename board_t>
+    static constexpr const board_t &unwrap(const board_t &board) {
+      return board;
+    }
+    template <typename board_t>
+    static constexpr const board_t &unwrap(const hashed_board<board_t> &board) {
+      return board.board;
+    }
+    template <typename T, typename U>
+    constexpr bool operator()(const T &lhs, const U &rhs) const {
+      return !(unwrap(lhs) != unwrap(rhs));
+    }
+  };
+}
+
+namespace std {
+  template <unsigned W, unsigned H, typename under_t>
+  struct hash<::reachability::board_t<W, H, under_t>> {
+    constexpr std::size_t operator()(const ::reachability::board_t<W, H, under_t> &board) const noexcept {
+      return ::reachability::hash_of(board);
+    }
+  };
+  template <unsigned W, unsigned H, typename under_t>
+  struct hash<::reachability::column_board_t<W, H, under_t>> {
+    constexpr std::size_t operator()(const ::reachability::column_board_t<W, H, under_t> &board) const noexcept {
+      return ::reachability::hash_of(board);
+    }
+  };
+  template <typename board_t>
+  struct hash<::reachability::hashed_board<board_t>> {
+    constexpr std::size_t operator()(const ::reachability::hashed_board<board_t> &board) const noexcept {
+      return board.hash;
+    }
+  };
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// reachability carried over from one board to the next.
+// the new search is seeded with old reachable positions that provably stay reachable: those far enough
+// above every changed row, provided the old search could never climb into them from below.
+// the seeds are then grown with the usual closure, so the result is exactly what a full search gives.
+namespace reachability::inline REACHABILITY_ISA::search {
+  template <block block, typename board_t>
+  struct reach_state {
+    board_t board;
+    std::array<board_t, block.shapes> usable;
+    std::array<board_t, block.orientations> reachable; // every reachable position, landable or not
+    constexpr std::array<board_t, block.shapes> landable() const {
+      std::array<board_t, block.shapes> ret;
+      static_for<block.orientations>([&][[gnu::always_inline]](auto i) {
+        constexpr auto index = block.mino_index[i][0_szc];
+        ret[index] |= reachable[i];
+      });
+      static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+        ret[i] &= landable_positions(usable[i]);
+      });
+      return ret;
+    }
+  };
+
+  // what happened to the board since the previous search, in this order
+  template <typename board_t>
+  struct board_delta {
+    board_t added;             // cells of the locked piece
+    std::uint64_t cleared = 0; // rows removed after adding, numbered before the removal
+    int raised = 0;            // garbage rows pushed in from the bottom afterwards
+  };
+
+  namespace details {
+    // rows between a position and the lowest cell it depends on: its own cells and every kick test made from it
+    template <block block>
+    constexpr int seed_margin = []{
+      int lowest_cell = 0, lowest_kick = 0;
+      static_for<block.shapes>([&](auto i) {
+        lowest_cell = std::min(lowest_cell, blocks::mino_range<block.minos[i]>()[1]);
+      });
+      static_for<std::tuple_size_v<decltype(block.kicks)>>([&](auto j) {
+        constexpr auto kick_table = block.kicks[j][1_szc];
+        static_for<std::tuple_size_v<decltype(kick_table)>>([&](auto k) {
+          lowest_kick = std::min(lowest_kick, int(kick_table[k][1_szc]));
+        });
+      });
+      return -lowest_cell - lowest_kick;
+    }();
+    template <block block>
+    constexpr int highest_kick = []{
+      int ret = 0;
+      static_for<std::tuple_size_v<decltype(block.kicks)>>([&](auto j) {
+        constexpr auto kick_table = block.kicks[j][1_szc];
+        static_for<std::tuple_size_v<decltype(kick_table)>>([&](auto k) {
+          ret = std::max(ret, int(kick_table[k][1_szc]));
+        });
+      });
+      return ret;
+    }();
+    template <typename board_t>
+    constexpr std::uint64_t rows_of(board_t board) {
+      return board.any_bit().populate_highest_bit().full_rows();
+    }
+  }
+
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  constexpr reach_state<block, board_t> reach(board_t data) {
+    reach_state<block, board_t> ret{data, {}, {}};
+    static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+      ret.usable[i] = usable_positions<block.minos[i]>(data);
+    });
+    soft_drop_closure<block, start, init_rot>(ret.usable.data(), ret.reachable);
+    return ret;
+  }
+
+  // reach(next) computed from the state of the previous board, next must be the previous board after delta.
+  // garbage, a change reaching the spawn, and old paths that climb back over the changed rows all fall back to reach
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  constexpr reach_state<block, board_t> repair(const reach_state<block, board_t> &prev, board_t next, const board_delta<board_t> &delta) {
+    constexpr int orientations = block.orientations;
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
+    if (delta.raised) [[unlikely]] {
+      return reach<block, start, init_rot>(next);
+    }
+    const std::uint64_t changed = details::rows_of(delta.added) | delta.cleared;
+    if (!changed) [[unlikely]] {
+      return prev;
+    }
+    // seeds lie in rows >= low (numbered before clearing), where nothing they depend on has changed
+    const int low = std::bit_width(changed) + details::seed_margin<block>;
+    const int lines = std::popcount(delta.cleared);
+    if (start2[1_szc] < low) [[unlikely]] {
+      return reach<block, start, init_rot>(next);
+    }
+    const board_t above = board_t::lines(~std::uint64_t(0) << low);
+    bool fallback = false;
+    static_for<std::tuple_size_v<decltype(block.kicks)>>([&][[gnu::always_inline]](auto j) {
+      constexpr auto this_kick = block.kicks[j];
+      constexpr auto kick_table = this_kick[1_szc];
+      constexpr auto source = index_c<this_kick[0_szc][0_szc]>;
+      constexpr auto index = index_c<block.mino_index[source][0_szc]>;
+      constexpr auto index2 = index_c<block.mino_index[index_c<this_kick[0_szc][1_szc]>][0_szc]>;
+      // rotate the old positions below the seed rows like apply_kicks does,
+      // an old path may have come back into the seed rows through an upward kick
+      board_t temp = prev.reachable[source] & ~above;
+      static_for<std::tuple_size_v<decltype(kick_table)>>([&][[gnu::always_inline]](auto k) {
+        if constexpr (kick_table[k][1_szc] > 0) {
+          fallback = fallback || (move_usable<block.minos[index], block.minos[index2], kick_table[k]>(temp) & prev.usable[index2] & above).any();
+        }
+        temp &= ~move_usable<block.minos[index2], block.minos[index], -kick_table[k]>(prev.usable[index2]);
+      });
+    });
+    if (lines) {
+      // seeds move down with the cleared rows, but kicks near the top would then test rows that used to be
+      // outside the board; and the seeds have to be reachable from the spawn by dropping it first
+      const board_t top = board_t::lines(~std::uint64_t(0) << (board_t::height - details::highest_kick<block>));
+      static_for<orientations>([&][[gnu::always_inline]](auto i) {
+        fallback = fallback || (prev.reachable[i] & top).any();
+      });
+    }
+    if (fallback) [[unlikely]] {
+      return reach<block, start, init_rot>(next);
+    }
+    reach_state<block, board_t> ret{next, {}, {}};
+    const auto &usable = ret.usable;
+    static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+      ret.usable[i] = usable_positions<block.minos[i]>(next);
+    });
+    board_t drop;
+    for (int k = 0; k <= lines; ++k) {
+      drop.set(start2[0_szc], start2[1_szc] - k);
+    }
+    if (!usable[init_rot2].contains(drop)) [[unlikely]] {
+      return reach<block, start, init_rot>(next);
+    }
+    bool need_visit[orientations];
+    static_for<orientations>([&][[gnu::always_inline]](auto i) {
+      ret.reachable[i] = (prev.reachable[i] & above).remove_lines(delta.cleared);
+      need_visit[i] = ret.reachable[i].any();
+    });
+    ret.reachable[init_rot] |= spawn_positions<block, start, init_rot>(usable.data()) | drop;
+    need_visit[init_rot] = true;
+    expand_closure<block>(usable.data(), ret.reachable, need_visit);
+    return ret;
+  }
+}
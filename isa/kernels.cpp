@@ -0,0 +1,31 @@
+// the kernels of one instruction set level, see dispatch.hpp: compiled once per level with its -march and
+// -DREACHABILITY_ISA=<level> by the Makefile, and linked into binaries that pick a level at runtime
+#include "../dispatch.hpp"
+#include "../registry.hpp"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace reachability::dispatch {
+  namespace {
+    // the word boards are stored in at this level
+    using under_t = ISA_UNDER_T;
+    using registry = geometry_registry<blocks::SRS, search::movement::soft_drop,
+      geometry<10, 20, under_t>, geometry<10, 24, under_t>, geometry<10, 40, under_t>>;
+    template <std::size_t i>
+    int binary_bfs(const std::uint64_t *rows, int piece, int x, int y, unsigned init_rot, std::uint64_t *out) {
+      constexpr auto height = std::size_t(registry::handles[i].height);
+      return registry::handles[i].binary_bfs({rows, height}, block_type(piece), coord{x, y}, init_rot, {out, 4 * height});
+    }
+    template <std::size_t i>
+    constexpr kernel kernel_of() {
+      return {registry::handles[i].width, registry::handles[i].height, &binary_bfs<i>};
+    }
+  }
+  const variant variants::REACHABILITY_ISA = {
+    level::REACHABILITY_ISA,
+    std::numeric_limits<under_t>::digits,
+    int(std::experimental::native_simd<std::uint8_t>::size() * 8),
+    {kernel_of<0>(), kernel_of<1>(), kernel_of<2>()}
+  };
+}
@@ -1,146 +1,90 @@
 #include "block.hpp"
 #include "board.hpp"
 #include "search.hpp"
+#include "generator.hpp"
 #include <string_view>
 #include <iostream>
+#include <cstdlib>
 #include "bench.hpp"
 using namespace std;
 
+// differential check of binary_bfs against ordinary_bfs_without_binary on generated boards:
+// every piece, spawn rotation and movement, with the spawn known at compile time, through the kernel table
+// and through the runtime seeded kernel
+// usage: main [boards per class] [seed]
+
 bool _ = ios::sync_with_stdio(false);
-template <reachability::blocks::block block, bool print=false, reachability::coord start=reachability::coord{4, 20}, unsigned init_rot=0>
-array<double, 2> test(const BOARD &b, string_view name) {
-  using namespace reachability::search;
-  cout << "BOARD " << name << endl;
-  auto binary = binary_bfs<block, start, init_rot>(b);
-  auto ordinary = ordinary_bfs_without_binary(b, block, start, init_rot);
-  if (binary.size() != ordinary.size()) {
-    cout << "  binary.size() != ordinary.size()" << endl;
-    cout << "  binary.size() = " << binary.size() << endl;
-    cout << "  ordinary.size() = " << ordinary.size() << endl;
-  }
-  for (size_t i = 0; i < min(binary.size(), ordinary.size()); ++i) {
-    if (binary[i] != ordinary[i]) {
-      cout << "  binary[" << i << "] != ordinary[" << i << "]" << endl;
-      cout << to_string(binary[i], ordinary[i], b);
-    } else if (print) {
-      cout << "  result[" << i << "]" << endl;
-      cout << to_string(binary[i], b);
+constexpr reachability::coord start{4, 20};
+constexpr reachability::coord other_start{3, 18};
+using spawns = reachability::search::spawn_range<4, 4, 20, 20>;
+
+struct checker {
+  size_t checks = 0, mismatches = 0;
+  void check(const auto &binary, const auto &ordinary, const BOARD &b, string_view what) {
+    ++checks;
+    bool same = binary.size() == ordinary.size();
+    for (size_t i = 0; same && i < binary.size(); ++i) {
+      same = !(binary[i] != ordinary[i]);
+    }
+    if (same) {
+      return;
+    }
+    if (++mismatches <= 10) {
+      cout << "MISMATCH " << what << endl;
+      cout << to_string(b);
+      for (size_t i = 0; i < min(binary.size(), ordinary.size()); ++i) {
+        if (binary[i] != ordinary[i]) {
+          cout << "  binary[" << i << "] != ordinary[" << i << "]" << endl;
+          cout << to_string(binary[i], ordinary[i], b);
+        }
+      }
     }
   }
-  auto binary_time = bench<100000000>([](auto b){ return binary_bfs<block, start, init_rot>(b); }, b);
-  cout << "  binary  : " << binary_time << " cycles" << endl;
-  auto ordinary_time = bench([](auto b){ return ordinary_bfs_without_binary(b, block, start, init_rot); }, b);
-  cout << "  true ord: " << ordinary_time << " cycles" << endl;
-  return {binary_time, ordinary_time};
-}
-template <bool print=false, reachability::coord start=reachability::coord{4, 20}, unsigned init_rot=0>
-array<double, 2> test(const BOARD &b, string_view name, reachability::block_type block) {
-  using namespace reachability::search;
-  using namespace reachability::blocks;
-  cout << "BOARD " << name << endl;
-  cout << " BLOCK " << name_of(block) << endl;
-  auto binary = binary_bfs<SRS, start, init_rot>(b, block);
-  auto ordinary = ordinary_bfs_without_binary<SRS>(b, block, start, init_rot);
-  if (binary.size() != ordinary.size()) {
-    cout << "  binary.size() != ordinary.size()" << endl;
-    cout << "  binary.size() = " << binary.size() << endl;
-    cout << "  ordinary.size() = " << ordinary.size() << endl;
-  }
-  for (size_t i = 0; i < min(binary.size(), ordinary.size()); ++i) {
-    if (binary[i] != ordinary[i]) {
-      cout << "  binary[" << i << "] != ordinary[" << i << "]" << endl;
-      cout << to_string(binary[i], ordinary[i], b);
-    } else if (print) {
-      cout << "  result[" << i << "]" << endl;
-      cout << to_string(binary[i], b);
+  template <typename RS, reachability::search::movement model>
+  void check_all(const BOARD &b, string_view name) {
+    using namespace reachability;
+    using namespace reachability::search;
+    for (int p = 0; p < 7; ++p) {
+      const auto piece = block_type(p);
+      static_for<4>([&](auto r) {
+        const auto what = string(name) + " " + name_of(piece) + " rotation " + std::to_string(r)
+          + (model == search::movement::soft_drop ? " soft drop" : " hard drop");
+        const auto ordinary = ordinary_bfs_without_binary<RS, model>(b, piece, start, r);
+        check(binary_bfs<RS, start, r, model>(b, piece), ordinary, b, what);
+        check(binary_bfs<RS, spawns, model>(b, piece, start, r), ordinary, b, what + " (kernel table)");
+        check(binary_bfs<RS, spawns, model>(b, piece, other_start, r),
+          ordinary_bfs_without_binary<RS, model>(b, piece, other_start, r), b, what + " (runtime spawn)");
+      });
     }
   }
-  auto binary_time = bench<100000000>([](auto b, auto block){ return binary_bfs<SRS, start, init_rot>(b, block); }, b, block);
-  cout << "  binary  : " << binary_time << " cycles" << endl;
-  auto ordinary_time = bench([](auto b, auto block){ return ordinary_bfs_without_binary<SRS>(b, block, start, init_rot); }, b, block);
-  cout << "  true ord: " << ordinary_time << " cycles" << endl;
-  return {binary_time, ordinary_time};
-}
-int main() {
-  double binary_sum = 0, ordinary_sum = 0;
-  using enum reachability::block_type;
-  constexpr reachability::block_type blocks[] = {T, Z, S, J, L, O, I};
+  template <typename RS>
+  void check_all(const BOARD &b, string_view name) {
+    check_all<RS, reachability::search::movement::soft_drop>(b, name);
+    check_all<RS, reachability::search::movement::hard_drop>(b, name);
+  }
+};
+
+int main(int argc, char **argv) {
+  using namespace reachability;
+  const size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000;
+  const uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+  checker srs, srs_plus;
   for (size_t i = 0; i < board_names.size(); ++i) {
-    for (auto block : blocks) {
-      auto [binary_time, ordinary_time] = test(boards[i], board_names[i], block);
-      binary_sum += binary_time;
-      ordinary_sum += ordinary_time;
+    srs.check_all<blocks::SRS>(boards[i], board_names[i]);
+    srs_plus.check_all<blocks::SRS_plus>(boards[i], board_names[i]);
+  }
+  for (auto kind : corpus::board_classes) {
+    corpus::generator<blocks::SRS, start, BOARD> g(kind, seed);
+    const auto before = srs.mismatches + srs_plus.mismatches;
+    for (size_t i = 0; i < count; ++i) {
+      const auto b = g.next();
+      const auto name = string(corpus::name_of(kind)) + " #" + std::to_string(i);
+      srs.check_all<blocks::SRS>(b, name);
+      srs_plus.check_all<blocks::SRS_plus>(b, name);
     }
+    cout << corpus::name_of(kind) << ": " << count << " boards, " << srs.mismatches + srs_plus.mismatches - before << " mismatches" << endl;
   }
-  cout << "TOTAL binary  : " << binary_sum << " cycles" << endl;
-  cout << "TOTAL true ord: " << ordinary_sum << " cycles" << endl;
-  using namespace reachability::blocks;
-  constexpr auto lzt = merge_str({
-    "XXXX  XXX ",
-    "XXXXX XXXX",
-    "      X  X",
-    "          ",
-    "   X      ",
-    "    XX X X",
-    "XXX X     ",
-    "XX  X    X",
-    "X    X    ",
-    "XX  XXXX X",
-    "X    XX   ",
-    "XX XXX    ",
-    "       X  ",
-    "      XXX ",
-    "XX X      ",
-    "X    X    ",
-    "X   X    X",
-    "X  XX X XX",
-    "XX  XXXXXX",
-  });
-  test<SRS::Z, true>(lzt, "LZT");
-  constexpr auto farter1 = merge_str({
-    "     X    ",
-    "XXX X     ",
-    "         X",
-    " X X  XX  ",
-    " X        ",
-    "    X X  X",
-    "X   XXX   ",
-    "X XX      ",
-    "       X  ",
-    "    X     ",
-    "  XX X X  ",
-    "X     XX  ",
-    "   X X    ",
-    " X      X ",
-    "    X     ",
-    "XX     X X",
-    "    X X   ",
-    "X  X      ",
-    "    XX    ",
-    "  X       ",
-    "       X  ",
-    " XXX XX X ",
-  });
-  test<SRS::L, true, reachability::coord{1, 1}, 2>(farter1, "FARTER 1");
-  constexpr auto farter2 = merge_str({
-    "       X  ",
-    "       X  ",
-    "   X   XX ",
-    "        X ",
-    "        X ",
-    "    X   XX",
-    "         X",
-    "         X",
-    "     X   X",
-    "          ",
-    "          ",
-    "      X   ",
-    "          ",
-    "          ",
-    "       X  ",
-    "          ",
-    "          ",
-    "          "
-  });
-  test<SRS::I, true, reachability::coord{7, 0}, 0>(farter2, "FARTER 2");
-}
\ No newline at end of file
+  cout << "SRS     : " << srs.checks << " checks, " << srs.mismatches << " mismatches" << endl;
+  cout << "SRS_plus: " << srs_plus.checks << " checks, " << srs_plus.mismatches << " mismatches" << endl;
+  return srs.mismatches + srs_plus.mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
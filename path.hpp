@@ -0,0 +1,193 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// input sequences for placements found by a layered version of binary_bfs.
+// layer k holds, per orientation, the positions first reached after exactly k inputs,
+// so a shortest path to any landing bit is recovered by walking the layers backwards
+// with bitboard moves, without searching again.
+namespace reachability::inline REACHABILITY_ISA::search {
+  enum class input : std::uint8_t {
+    left, right, soft_drop, cw, ccw, flip
+  };
+  struct step {
+    input type;
+    std::uint8_t orientation; // orientation after this input
+    std::uint8_t kick;        // index in the kick table of the rotation, 0 for moves
+  };
+
+  template <block block, typename board_t>
+  struct trace {
+    static constexpr int orientations = block.orientations;
+    static constexpr int shapes = block.shapes;
+    std::array<board_t, shapes> usable;
+    std::array<board_t, shapes> landable; // same as binary_bfs
+    std::vector<std::array<board_t, orientations>> layers;
+
+    // shortest input sequence from the spawn to the landing position (x, y) of shape
+    // (coordinates as in landable), or nullopt if it is not landable
+    std::optional<std::vector<step>> path(int shape, int x, int y) const {
+      if (shape < 0 || shape >= shapes || x < 0 || x >= board_t::width || y < 0 || y >= board_t::height) {
+        return std::nullopt;
+      }
+      board_t pos;
+      pos.set(x, y);
+      int depth = -1, orientation = -1;
+      for (std::size_t k = 0; k < layers.size() && depth < 0; ++k) {
+        static_for<orientations>([&][[gnu::always_inline]](auto i) {
+          if (depth < 0 && block.mino_index[i][0_szc] == shape && (layers[k][i] & pos).any()) {
+            depth = k;
+            orientation = i;
+          }
+        });
+      }
+      if (depth < 0 || !(landable[shape] & pos).any()) {
+        return std::nullopt;
+      }
+      std::vector<step> ret(depth);
+      for (int k = depth; k > 0; --k) {
+        bool found = false;
+        static_for<orientations>([&][[gnu::always_inline]](auto i) {
+          if (found || orientation != int(i)) {
+            return;
+          }
+          found = back_step<i>(layers[k - 1], pos, orientation, ret[k - 1]);
+        });
+      }
+      return ret;
+    }
+  private:
+    static constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    static constexpr input rotation_input(int from, int to) {
+      const int diff = (to - from + orientations) % orientations;
+      return diff == 1 ? input::cw : diff == orientations - 1 ? input::ccw : input::flip;
+    }
+    // find a position in previous that reaches pos (in orientation i) with one input,
+    // then move pos and orientation to it and record the input
+    template <std::size_t i>
+    bool back_step(const std::array<board_t, orientations> &previous, board_t &pos, int &orientation, step &out) const {
+      constexpr auto index = block.mino_index[index_c<i>][0_szc];
+      bool found = false;
+      static_for<MOVES.size()>([&][[gnu::always_inline]](auto j) {
+        if (found) {
+          return;
+        }
+        const board_t from = pos.template move<-MOVES[j]>() & previous[i];
+        if (from.any()) {
+          found = true;
+          pos = from;
+          out = {j == 0 ? input::left : j == 1 ? input::right : input::soft_drop, std::uint8_t(i), 0};
+        }
+      });
+      static_for<std::tuple_size_v<decltype(block.kicks)>>([&][[gnu::always_inline]](auto j) {
+        constexpr auto this_kick = block.kicks[j];
+        constexpr auto diff = this_kick[0_szc];
+        constexpr auto kick_table = this_kick[1_szc];
+        if constexpr (diff[1_szc] == i) {
+          constexpr auto source = index_c<diff[0_szc]>;
+          static_for<std::tuple_size_v<decltype(kick_table)>>([&][[gnu::always_inline]](auto k) {
+            if (found) {
+              return;
+            }
+            const board_t from = pos.template move<-kick_table[k]>() & previous[source];
+            if (!from.any()) {
+              return;
+            }
+            // the rotation only lands here if every earlier kick was blocked
+            bool blocked = true;
+            static_for<k>([&][[gnu::always_inline]](auto l) {
+              blocked = blocked && !(from.template move<kick_table[l]>() & usable[index]).any();
+            });
+            if (blocked) {
+              found = true;
+              pos = from;
+              orientation = source;
+              out = {rotation_input(source, i), std::uint8_t(i), std::uint8_t(k)};
+            }
+          });
+        }
+      });
+      return found;
+    }
+  };
+
+  // binary_bfs expanded one input at a time, recording every layer;
+  // slower than binary_bfs (no fast path, one step per iteration), so only use it when paths are needed
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  trace<block, board_t> binary_bfs_trace(board_t data) {
+    constexpr int orientations = block.orientations;
+    constexpr int shapes = block.shapes;
+    trace<block, board_t> ret;
+    auto &usable = ret.usable;
+    static_for<shapes>([&][[gnu::always_inline]](auto i) {
+      usable[i] = usable_positions<block.minos[i]>(data);
+    });
+    constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
+    if (!usable[init_rot2].template get<start2[0_szc], start2[1_szc]>()) [[unlikely]] {
+      return ret;
+    }
+    std::array<board_t, orientations> visited, frontier;
+    frontier[init_rot].template set<start2[0_szc], start2[1_szc]>();
+    visited = frontier;
+    for (bool any = true; any;) {
+      ret.layers.push_back(frontier);
+      std::array<board_t, orientations> next;
+      static_for<orientations>([&][[gnu::always_inline]](auto i) {
+        if (!frontier[i].any()) {
+          return;
+        }
+        constexpr auto index = index_c<block.mino_index[i][0_szc]>;
+        static_for<MOVES.size()>([&][[gnu::always_inline]](auto j) {
+          next[i] |= move_usable<block.minos[index], block.minos[index], MOVES[j]>(frontier[i]);
+        });
+        static_for<std::tuple_size_v<decltype(block.kicks)>>([&][[gnu::always_inline]](auto j) {
+          constexpr auto this_kick = block.kicks[j];
+          constexpr auto diff = this_kick[0_szc];
+          constexpr auto kick_table = this_kick[1_szc];
+          if constexpr (diff[0_szc] != i) {
+            return;
+          }
+          constexpr auto target = index_c<diff[1_szc]>;
+          constexpr auto index2 = index_c<block.mino_index[target][0_szc]>;
+          board_t temp = frontier[i];
+          static_for<std::tuple_size_v<decltype(kick_table)>>([&][[gnu::always_inline]](auto k) {
+            next[target] |= move_usable<block.minos[index], block.minos[index2], kick_table[k]>(temp) & usable[index2];
+            temp &= ~move_usable<block.minos[index2], block.minos[index], -kick_table[k]>(usable[index2]);
+          });
+        });
+      });
+      any = false;
+      static_for<orientations>([&][[gnu::always_inline]](auto i) {
+        constexpr auto index = block.mino_index[i][0_szc];
+        frontier[i] = next[i] & usable[index] & ~visited[i];
+        visited[i] |= frontier[i];
+        any = any || frontier[i].any();
+      });
+    }
+    static_for<orientations>([&][[gnu::always_inline]](auto i) {
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret.landable[index] |= visited[i];
+    });
+    static_for<shapes>([&][[gnu::always_inline]](auto i) {
+      ret.landable[i] &= landable_positions(usable[i]);
+    });
+    return ret;
+  }
+
+  // one-shot path query for a runtime piece, use binary_bfs_trace directly to query many placements of one search
+  template <typename RS, coord start, unsigned init_rot=0, typename board_t>
+  [[gnu::noinline]]
+  std::optional<std::vector<step>> find_path(board_t data, block_type b, int shape, int x, int y) {
+    return call_with_block<RS>(b, [=]<block B>() {
+      return binary_bfs_trace<B, start, init_rot % B.orientations>(data).path(shape, x, y);
+    });
+  }
+}
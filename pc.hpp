@@ -0,0 +1,233 @@
+#pragma once
+#include "beam.hpp"
+#include "block.hpp"
+#include "hash.hpp"
+#include "pool.hpp"
+#include "search.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// perfect clears: every placement sequence from a piece queue (with hold) that clears the lowest rows of the board
+// and leaves it empty. placements come from binary_bfs, restricted to the rows still to be cleared, and are locked with
+// clear_full_lines. a board is dropped as soon as its empty cells cannot be tiled by the pieces left (cell count,
+// checkerboard parity, regions whose size is not a multiple of 4), and boards known to have no solution are remembered.
+// the placements of the first piece are shared out over a thread pool.
+namespace reachability::inline REACHABILITY_ISA::search {
+  struct pc_options {
+    int height = 4;                // rows to clear, the board must be empty above them
+    std::size_t max_solutions = 0; // stop after this many, 0 for all of them
+    bool use_hold = true;
+    int table_bits = 20;           // the table of dead boards holds 2^table_bits boards
+  };
+
+  template <typename board_t>
+  struct pc_result {
+    std::vector<std::vector<placement<board_t>>> solutions;
+    double first_solution; // seconds until the first solution was found, negative if there is none
+    std::size_t nodes;     // boards visited
+  };
+
+  namespace details {
+    template <typename board_t>
+    constexpr board_t lowest_cell(board_t board) {
+      auto words = board.to_array();
+      bool found = false;
+      for (auto &word : words) {
+        word = found ? 0 : word & -word;
+        found = found || word;
+      }
+      return words;
+    }
+    template <typename board_t>
+    constexpr board_t checkerboard() {
+      board_t ret;
+      for (int y = 0; y < board_t::height; ++y) {
+        for (int x = y % 2; x < board_t::width; x += 2) {
+          ret.set(x, y);
+        }
+      }
+      return ret;
+    }
+    // every 4-connected region of empty must be tiled by whole pieces
+    template <typename board_t>
+    constexpr bool fillable(board_t empty) {
+      while (empty.any()) {
+        board_t region = lowest_cell(empty);
+        while (true) {
+          const board_t grown = (region | region.template move<coord{1, 0}>() | region.template move<coord{-1, 0}>()
+            | region.template move<coord{0, 1}>() | region.template move<coord{0, -1}>()) & empty;
+          if (region.contains(grown)) {
+            break;
+          }
+          region = grown;
+        }
+        if (region.count() % 4) {
+          return false;
+        }
+        empty &= ~region;
+      }
+      return true;
+    }
+
+    template <typename board_t>
+    struct pc_state {
+      board_t board;
+      int rows;         // rows left to clear
+      std::size_t next; // pieces of the queue used so far, placed or held
+      std::optional<block_type> hold;
+    };
+
+    template <typename RS, coord start, typename board_t>
+    class pc_solver {
+    public:
+      using state = pc_state<board_t>;
+      pc_solver(std::span<const block_type> queue, const pc_options &options):
+        queue(queue), options(options), dead(options.table_bits), begin(std::chrono::steady_clock::now()) {}
+
+      // f(child, placement) for every placement of every piece the state can play next
+      template <typename F>
+      void for_each_child(const state &s, F f) const {
+        const auto place = [&](block_type piece, std::optional<block_type> hold, std::size_t next) {
+          const board_t ceiling = ~board_t::lines((std::uint64_t(1) << s.rows) - 1);
+          call_with_block<RS>(piece, [&]<block B>() {
+            const auto landable = binary_bfs<B, start, 0>(s.board);
+            static_for<B.shapes>([&](auto i) {
+              const board_t fits = landable[i] & usable_positions<B.minos[i]>(ceiling);
+              for_each_lock<B.minos[i]>(s.board, fits, [&](int x, int y, const clear_result<board_t> &result) {
+                const auto &[board, lines, rows] = result;
+                f(state{board, s.rows - lines, next, hold}, placement<board_t>{board, piece, std::uint8_t(i), std::int8_t(x), std::int8_t(y), std::uint8_t(lines)});
+              });
+            });
+          });
+        };
+        const std::size_t next = s.next;
+        if (next >= queue.size()) {
+          return;
+        }
+        place(queue[next], s.hold, next + 1);
+        if (!options.use_hold) {
+          return;
+        }
+        if (s.hold) {
+          if (*s.hold != queue[next]) {
+            place(*s.hold, queue[next], next + 1);
+          }
+        } else if (next + 1 < queue.size()) {
+          place(queue[next + 1], queue[next], next + 2);
+        }
+      }
+      // false if the empty cells of s can certainly not be filled with what is left
+      bool possible(const state &s) const {
+        const board_t empty = ~s.board & board_t::lines((std::uint64_t(1) << s.rows) - 1);
+        const int cells = empty.count();
+        std::size_t left = queue.size() - s.next + (s.hold ? 1 : 0);
+        if (cells % 4 || std::size_t(cells / 4) > left) {
+          return false;
+        }
+        // a T covers 3 cells of one colour and 1 of the other, every other piece 2 and 2
+        std::size_t t = std::count(queue.begin() + s.next, queue.end(), block_type::T) + (s.hold == block_type::T);
+        const int diff = 2 * (empty & black).count() - cells;
+        if (std::size_t(std::abs(diff) / 2) > t) {
+          return false;
+        }
+        return fillable(empty);
+      }
+      std::uint64_t key(const state &s) const {
+        return hash_of(s.board) ^ reachability::details::mix(s.next << 8 | std::size_t(s.rows) << 3 | (s.hold ? std::size_t(*s.hold) + 1 : 0));
+      }
+      // solutions below s, appended to out after path
+      std::size_t solve(const state &s, std::vector<placement<board_t>> &path, std::vector<std::vector<placement<board_t>>> &out, std::size_t &nodes) {
+        ++nodes;
+        if (s.rows == 0) {
+          found(path, out);
+          return 1;
+        }
+        if (stopped.load(std::memory_order_relaxed) || !possible(s) || dead.contains(key(s))) {
+          return 0;
+        }
+        std::size_t ret = 0;
+        for_each_child(s, [&](const state &child, const placement<board_t> &p) {
+          if (stopped.load(std::memory_order_relaxed)) {
+            return;
+          }
+          path.push_back(p);
+          ret += solve(child, path, out, nodes);
+          path.pop_back();
+        });
+        // an interrupted search proves nothing
+        if (!ret && !stopped.load(std::memory_order_relaxed)) {
+          dead.insert(key(s));
+        }
+        return ret;
+      }
+      double first_solution() const {
+        return first.load();
+      }
+    private:
+      void found(const std::vector<placement<board_t>> &path, std::vector<std::vector<placement<board_t>>> &out) {
+        const std::size_t n = solutions.fetch_add(1, std::memory_order_relaxed);
+        if (options.max_solutions && n >= options.max_solutions) {
+          stopped.store(true, std::memory_order_relaxed);
+          return;
+        }
+        if (n == 0) {
+          first.store(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+        if (options.max_solutions && n + 1 == options.max_solutions) {
+          stopped.store(true, std::memory_order_relaxed);
+        }
+        out.push_back(path);
+      }
+      std::span<const block_type> queue;
+      const pc_options &options;
+      const board_t black = checkerboard<board_t>();
+      transposition_table dead;
+      std::chrono::steady_clock::time_point begin;
+      std::atomic<std::size_t> solutions = 0;
+      std::atomic<double> first = -1;
+      std::atomic<bool> stopped = false;
+    };
+  }
+
+  // every perfect clear of the lowest options.height rows of board with queue and hold (up to options.max_solutions),
+  // the board must be empty above those rows
+  template <typename RS, coord start, typename board_t>
+  pc_result<board_t> perfect_clear(thread_pool &pool, board_t board, std::span<const block_type> queue, std::optional<block_type> hold, pc_options options = {}) {
+    using state = details::pc_state<board_t>;
+    pc_result<board_t> ret{{}, -1, 0};
+    if ((board & ~board_t::lines((std::uint64_t(1) << options.height) - 1)).any()) {
+      return ret;
+    }
+    details::pc_solver<RS, start, board_t> solver(queue, options);
+    const state root{board, options.height, 0, hold};
+    if (options.height == 0 || !solver.possible(root)) {
+      return ret;
+    }
+    std::vector<std::pair<state, placement<board_t>>> tasks;
+    solver.for_each_child(root, [&](const state &child, const placement<board_t> &p) {
+      tasks.emplace_back(child, p);
+    });
+    ret.nodes = 1;
+    std::vector<pc_result<board_t>> partial(pool.size(), pc_result<board_t>{{}, -1, 0});
+    std::atomic<std::size_t> next = 0;
+    pool.run([&](unsigned id) {
+      std::vector<placement<board_t>> path;
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < tasks.size();) {
+        path.assign(1, tasks[i].second);
+        solver.solve(tasks[i].first, path, partial[id].solutions, partial[id].nodes);
+      }
+    });
+    for (auto &p : partial) {
+      ret.nodes += p.nodes;
+      ret.solutions.insert(ret.solutions.end(), std::make_move_iterator(p.solutions.begin()), std::make_move_iterator(p.solutions.end()));
+    }
+    ret.first_solution = solver.first_solution();
+    return ret;
+  }
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// many boards at once on every core: a pool of threads that live as long as the pool,
+// each optionally pinned to a cpu, and a batch of (board, piece) jobs split over them
+namespace reachability::inline REACHABILITY_ISA {
+  // cpus of a NUMA node as listed in sysfs, throws if the node does not exist
+  inline std::vector<int> numa_cpus(int node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(file, list)) {
+      throw std::runtime_error("no NUMA node " + std::to_string(node));
+    }
+    // "0-7,16-23"
+    std::vector<int> ret;
+    for (std::size_t pos = 0; pos < list.size();) {
+      std::size_t end = list.find(',', pos);
+      if (end == std::string::npos) {
+        end = list.size();
+      }
+      const std::string range = list.substr(pos, end - pos);
+      const std::size_t dash = range.find('-');
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        ret.push_back(cpu);
+      }
+      pos = end + 1;
+    }
+    return ret;
+  }
+
+  class thread_pool {
+  public:
+    // thread i is pinned to cpus[i % cpus.size()], no pinning if cpus is empty
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency(), std::span<const int> cpus = {}) {
+      threads = std::max(threads, 1u);
+      workers.reserve(threads);
+      for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i, cpu = cpus.empty() ? -1 : cpus[i % cpus.size()]] {
+          if (cpu >= 0) {
+            pin(cpu);
+          }
+          loop(i);
+        });
+      }
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+    ~thread_pool() {
+      {
+        std::lock_guard lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (auto &worker : workers) {
+        worker.join();
+      }
+    }
+    unsigned size() const {
+      return workers.size();
+    }
+    // f(thread) on every thread of the pool, returns once all of them are done
+    void run(std::function<void(unsigned)> f) {
+      std::unique_lock lock(mutex);
+      task = std::move(f);
+      running = size();
+      ++generation;
+      wake.notify_all();
+      done.wait(lock, [&] { return running == 0; });
+      task = nullptr;
+    }
+  private:
+    static void pin([[maybe_unused]] int cpu) {
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+    void loop(unsigned id) {
+      std::uint64_t seen = 0;
+      while (true) {
+        std::unique_lock lock(mutex);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = generation;
+        lock.unlock();
+        task(id);
+        lock.lock();
+        if (--running == 0) {
+          done.notify_one();
+        }
+      }
+    }
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::function<void(unsigned)> task;
+    std::uint64_t generation = 0;
+    unsigned running = 0;
+    bool stopping = false;
+  };
+
+  namespace search {
+    template <typename board_t>
+    struct reach_job {
+      board_t board;
+      block_type piece;
+    };
+
+    // out[i] = binary_bfs<RS, start>(jobs[i].board, jobs[i].piece), out must hold jobs.size() entries.
+    // threads take chunk jobs at a time, so every thread writes whole chunks of out and never shares a cache line
+    template <typename RS, coord start, unsigned init_rot=0, movement model=movement::soft_drop, std::size_t chunk=64, typename board_t>
+    void binary_bfs_jobs(thread_pool &pool, std::span<const reach_job<board_t>> jobs, std::span<static_vector<board_t, 4>> out) {
+      std::atomic<std::size_t> next = 0;
+      pool.run([&](unsigned) {
+        for (std::size_t begin; (begin = next.fetch_add(chunk, std::memory_order_relaxed)) < jobs.size();) {
+          const std::size_t end = std::min(begin + chunk, jobs.size());
+          for (std::size_t i = begin; i < end; ++i) {
+            out[i] = binary_bfs<RS, start, init_rot, model>(jobs[i].board, jobs[i].piece);
+          }
+        }
+      });
+    }
+  }
+}
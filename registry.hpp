@@ -0,0 +1,89 @@
+#pragma once
+#include "block.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+
+// board geometries chosen at runtime.
+// every geometry of a registry is compiled as its own board_t, so a 10x20 board uses the words of 20 rows,
+// and boards cross the runtime boundary as one bit mask per row (bit x of rows[y] is cell (x, y)).
+namespace reachability::inline REACHABILITY_ISA {
+  // W x H boards stored in under_t words; the spawns in spawns get their own kernels (see search::spawn_range),
+  // by default the usual spawn column and 4 rows below the top
+  template <unsigned W, unsigned H, typename under_t=std::uint64_t,
+    typename spawns=search::spawn_range<int(W) / 2 - 1, int(W) / 2 - 1, int(H) - 4, int(H) - 4>>
+  struct geometry {
+    using board = board_t<W, H, under_t>;
+    using spawn_table = spawns;
+  };
+
+  // a registered geometry behind function pointers
+  struct geometry_handle {
+    int width;
+    int height;
+    int under_bits;
+    int num_of_under;
+    // landable positions of the piece as rows, shape s at out[s * height, (s + 1) * height)
+    // rows must hold height entries and out 4 * height entries, returns the number of shapes
+    int (*binary_bfs)(std::span<const std::uint64_t> rows, block_type b, coord start, unsigned init_rot, std::span<std::uint64_t> out);
+  };
+
+  namespace details {
+    template <typename board_t>
+    constexpr board_t from_rows(std::span<const std::uint64_t> rows) {
+      using words_t = decltype(board_t().to_array());
+      constexpr auto line = ~std::uint64_t(0) >> (64 - board_t::width);
+      words_t words = {};
+      for (int y = 0; y < board_t::height; ++y) {
+        words[y / board_t::lines_per_under] |= typename words_t::value_type(rows[y] & line) << (y % board_t::lines_per_under * board_t::width);
+      }
+      return words;
+    }
+    template <typename board_t>
+    constexpr void to_rows(board_t board, std::span<std::uint64_t> rows) {
+      constexpr auto line = ~std::uint64_t(0) >> (64 - board_t::width);
+      const auto words = board.to_array();
+      for (int y = 0; y < board_t::height; ++y) {
+        rows[y] = std::uint64_t(words[y / board_t::lines_per_under] >> (y % board_t::lines_per_under * board_t::width)) & line;
+      }
+    }
+    template <typename RS, typename geometry, search::movement model>
+    int erased_binary_bfs(std::span<const std::uint64_t> rows, block_type b, coord start, unsigned init_rot, std::span<std::uint64_t> out) {
+      using board = typename geometry::board;
+      const auto shapes = search::binary_bfs<RS, typename geometry::spawn_table, model>(from_rows<board>(rows), b, start, init_rot);
+      for (std::size_t i = 0; i < shapes.size(); ++i) {
+        to_rows(shapes[i], out.subspan(i * board::height, board::height));
+      }
+      return shapes.size();
+    }
+  }
+
+  template <typename RS, search::movement model, typename... geometries>
+  class geometry_registry {
+  public:
+    static constexpr std::array<geometry_handle, sizeof...(geometries)> handles = {
+      geometry_handle{
+        geometries::board::width,
+        geometries::board::height,
+        geometries::board::under_bits,
+        geometries::board::num_of_under,
+        &details::erased_binary_bfs<RS, geometries, model>
+      }...
+    };
+    // the handle of the first registered W x H geometry, or nullptr
+    static constexpr const geometry_handle *find(int width, int height) {
+      for (const auto &handle : handles) {
+        if (handle.width == width && handle.height == height) {
+          return &handle;
+        }
+      }
+      return nullptr;
+    }
+  };
+  // the sizes we run, with 64-bit words (6 rows of 10 per word: 4 words up to 24 rows, 7 for 40)
+  template <typename RS, search::movement model=search::movement::soft_drop>
+  using default_registry = geometry_registry<RS, model, geometry<10, 20>, geometry<10, 24>, geometry<10, 40>>;
+}
@@ -0,0 +1,330 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// rotation systems known only at runtime, e.g. loaded from a config file at startup.
+// rule_engine runs the compiled binary_bfs for every piece whose table matches a compiled rotation system,
+// and binary_bfs_interpreted, which reads the kick tables at runtime, for everything else.
+namespace reachability::inline REACHABILITY_ISA::blocks {
+  using cell = std::array<int, 2>;
+
+  // runtime counterpart of block, with the same meaning for every field (kicks already combined with the offsets)
+  struct runtime_block {
+    struct orientation {
+      int shape;
+      cell offset;
+      constexpr bool operator==(const orientation &) const = default;
+    };
+    struct kick {
+      int from, to;
+      std::vector<cell> tests;
+      constexpr bool operator==(const kick &) const = default;
+    };
+    std::vector<std::vector<cell>> minos;
+    std::vector<orientation> mino_index;
+    std::vector<kick> kicks;
+    constexpr int shapes() const {
+      return minos.size();
+    }
+    constexpr int orientations() const {
+      return mino_index.size();
+    }
+    constexpr bool operator==(const runtime_block &) const = default;
+  };
+  // indexed by block_type
+  using rotation_system = std::array<runtime_block, 7>;
+
+  template <block B>
+  constexpr runtime_block to_runtime() {
+    runtime_block ret;
+    static_for<B.shapes>([&](auto i) {
+      auto &mino = ret.minos.emplace_back();
+      static_for<std::tuple_size_v<std::remove_cvref_t<decltype(B.minos[i])>>>([&](auto j) {
+        mino.push_back({B.minos[i][j][0_szc], B.minos[i][j][1_szc]});
+      });
+    });
+    static_for<B.orientations>([&](auto i) {
+      const auto offset = B.mino_index[i][1_szc];
+      ret.mino_index.push_back({B.mino_index[i][0_szc], {offset[0_szc], offset[1_szc]}});
+    });
+    static_for<std::tuple_size_v<decltype(B.kicks)>>([&](auto j) {
+      const auto diff = B.kicks[j][0_szc];
+      constexpr auto kick_table = B.kicks[j][1_szc];
+      auto &kick = ret.kicks.emplace_back(diff[0_szc], diff[1_szc]);
+      static_for<std::tuple_size_v<decltype(kick_table)>>([&](auto k) {
+        kick.tests.push_back({kick_table[k][0_szc], kick_table[k][1_szc]});
+      });
+    });
+    return ret;
+  }
+  template <typename RS>
+  rotation_system to_runtime() {
+    rotation_system ret;
+    using enum block_type;
+    for (const auto b : {T, Z, S, J, L, O, I}) {
+      call_with_block<RS>(b, [&]<block B>() {
+        ret[std::size_t(b)] = to_runtime<B>();
+      });
+    }
+    return ret;
+  }
+
+  // text format, one directive per line, # starts a comment:
+  //   piece T                        following lines describe T, every piece must appear once
+  //   shape -1,0 0,0 1,0 0,1         cells of the next shape
+  //   orientation 0 0,0              shape and offset of the next orientation (default: one per shape, offset 0,0)
+  //   kick 0 2 0,0 0,1 1,1           tests of the rotation from orientation 0 to 2, in SRS convention
+  // kick tests are relative to the offsets like pure_kick, they are combined when loading
+  inline rotation_system parse_rotation_system(std::string_view text) {
+    rotation_system ret;
+    bool seen[7] = {};
+    runtime_block *current = nullptr;
+    int line_number = 0;
+    const auto fail = [&](const std::string &message) {
+      throw std::runtime_error("rotation system: line " + std::to_string(line_number) + ": " + message);
+    };
+    const auto parse_cell = [&](const std::string &word) {
+      cell c;
+      char comma = 0;
+      std::istringstream in(word);
+      if (!(in >> c[0] >> comma >> c[1]) || comma != ',' || !in.eof()) fail("bad cell '" + word + "'");
+      return c;
+    };
+    const auto parse_int = [&](const std::string &word) {
+      int v = 0;
+      std::istringstream in(word);
+      if (!(in >> v) || !in.eof()) fail("bad number '" + word + "'");
+      return v;
+    };
+    const auto finish = [&] {
+      if (!current) return;
+      if (current->minos.empty() || current->minos.size() > 4) fail("a piece needs 1 to 4 shapes");
+      if (current->mino_index.empty()) {
+        for (int i = 0; i < current->shapes(); ++i) current->mino_index.push_back({i, {0, 0}});
+      }
+      if (current->orientations() > 4) fail("a piece has at most 4 orientations");
+      for (const auto &o : current->mino_index) {
+        if (o.shape < 0 || o.shape >= current->shapes()) fail("orientation of an unknown shape");
+      }
+      for (auto &k : current->kicks) {
+        if (k.from < 0 || k.from >= current->orientations() || k.to < 0 || k.to >= current->orientations() || k.from == k.to) {
+          fail("kick between unknown orientations");
+        }
+        // same as combine
+        const auto &from = current->mino_index[k.from].offset, &to = current->mino_index[k.to].offset;
+        for (auto &t : k.tests) {
+          t = {t[0] - from[0] + to[0], t[1] - from[1] + to[1]};
+        }
+      }
+    };
+    for (std::size_t pos = 0; pos < text.size();) {
+      const std::size_t end = std::min(text.find('\n', pos), text.size());
+      std::string line(text.substr(pos, end - pos));
+      pos = end + 1;
+      ++line_number;
+      line = line.substr(0, line.find('#'));
+      std::istringstream in(line);
+      std::string directive;
+      if (!(in >> directive)) continue;
+      std::vector<std::string> words;
+      for (std::string word; in >> word;) words.push_back(word);
+      if (directive == "piece") {
+        if (words.size() != 1 || words[0].size() != 1 || std::string_view("TZSJLOI").find(words[0][0]) == std::string_view::npos) {
+          fail("expected one of T Z S J L O I");
+        }
+        const auto b = std::size_t(block_from_name(words[0][0]));
+        if (seen[b]) fail("piece " + words[0] + " appears twice");
+        finish();
+        seen[b] = true;
+        current = &ret[b];
+        continue;
+      }
+      if (!current) fail("'" + directive + "' before the first piece");
+      if (directive == "shape") {
+        if (words.empty()) fail("a shape needs at least one cell");
+        auto &mino = current->minos.emplace_back();
+        for (const auto &word : words) mino.push_back(parse_cell(word));
+      } else if (directive == "orientation") {
+        if (words.size() != 2) fail("expected a shape and an offset");
+        current->mino_index.push_back({parse_int(words[0]), parse_cell(words[1])});
+      } else if (directive == "kick") {
+        if (words.size() < 3) fail("expected two orientations and at least one test");
+        auto &kick = current->kicks.emplace_back(parse_int(words[0]), parse_int(words[1]));
+        for (std::size_t i = 2; i < words.size(); ++i) kick.tests.push_back(parse_cell(words[i]));
+      } else {
+        fail("unknown directive '" + directive + "'");
+      }
+    }
+    finish();
+    for (std::size_t b = 0; b < 7; ++b) {
+      if (!seen[b]) fail(std::string("piece ") + name_of(block_type(b)) + " is missing");
+    }
+    return ret;
+  }
+  inline rotation_system load_rotation_system(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("rotation system: cannot open " + path);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return parse_rotation_system(text.str());
+  }
+  // the text parse_rotation_system reads back into rs
+  inline std::string to_text(const rotation_system &rs) {
+    std::ostringstream out;
+    const auto put = [&](const cell &c) { out << ' ' << c[0] << ',' << c[1]; };
+    for (std::size_t b = 0; b < 7; ++b) {
+      const auto &piece = rs[b];
+      out << "piece " << name_of(block_type(b)) << '\n';
+      for (const auto &mino : piece.minos) {
+        out << "shape";
+        for (const auto &c : mino) put(c);
+        out << '\n';
+      }
+      for (const auto &o : piece.mino_index) {
+        out << "orientation " << o.shape;
+        put(o.offset);
+        out << '\n';
+      }
+      for (const auto &k : piece.kicks) {
+        const auto &from = piece.mino_index[k.from].offset, &to = piece.mino_index[k.to].offset;
+        out << "kick " << k.from << ' ' << k.to;
+        for (const auto &t : k.tests) put({t[0] + from[0] - to[0], t[1] + from[1] - to[1]});
+        out << '\n';
+      }
+    }
+    return out.str();
+  }
+}
+
+namespace reachability::inline REACHABILITY_ISA::search {
+  template <typename board_t>
+  constexpr board_t usable_positions(board_t data, std::span<const blocks::cell> mino) {
+    board_t positions = ~board_t();
+    for (const auto &[x, y] : mino) {
+      positions &= y > 0 ? (~data.move(0, -y)).move(-x, 0) : (~data).move(-x, -y);
+    }
+    return positions;
+  }
+  // binary_bfs with the piece and its kicks read at runtime, same results as binary_bfs of the compiled block
+  template <typename board_t>
+  static_vector<board_t, 4> binary_bfs_interpreted(board_t data, const blocks::runtime_block &block, coord start, unsigned init_rot) {
+    const int orientations = block.orientations();
+    const int shapes = block.shapes();
+    std::array<board_t, 4> usable, ret;
+    for (int i = 0; i < shapes; ++i) {
+      usable[i] = usable_positions(data, std::span{block.minos[i]});
+    }
+    const auto &[init_rot2, offset] = block.mino_index[init_rot];
+    const int x = start[0_szc] + offset[0], y = start[1_szc] + offset[1];
+    if (usable[init_rot2].get(x, y) != 1) [[unlikely]] {
+      return std::span{ret.data(), std::size_t(shapes)};
+    }
+    constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    bool need_visit[4] = {};
+    need_visit[init_rot] = true;
+    std::array<board_t, 4> cache;
+    cache[init_rot] = spawn_positions(usable[init_rot2], x, y);
+    for (bool updated = true; updated;) {
+      updated = false;
+      for (int i = 0; i < orientations; ++i) {
+        if (!need_visit[i]) {
+          continue;
+        }
+        const int index = block.mino_index[i].shape;
+        need_visit[i] = false;
+        while (true) {
+          board_t result = cache[i];
+          static_for<MOVES.size()>([&][[gnu::always_inline]](auto j) {
+            result |= cache[i].template move<MOVES[j]>();
+          });
+          result &= usable[index];
+          if (cache[i].contains(result)) {
+            break;
+          }
+          cache[i] = result;
+        }
+        for (const auto &[from, target, tests] : block.kicks) {
+          if (from != i) {
+            continue;
+          }
+          const int index2 = block.mino_index[target].shape;
+          board_t to = cache[target];
+          board_t temp = cache[i];
+          for (const auto &[dx, dy] : tests) {
+            to |= temp.move(dx, dy);
+            temp &= ~usable[index2].move(-dx, -dy);
+          }
+          to &= usable[index2];
+          if (!cache[target].contains(to)) {
+            need_visit[target] = true;
+            if (target < i)
+              updated = true;
+          }
+          cache[target] = to;
+        }
+      }
+    }
+    for (int i = 0; i < orientations; ++i) {
+      ret[block.mino_index[i].shape] |= cache[i];
+    }
+    for (int i = 0; i < shapes; ++i) {
+      ret[i] &= landable_positions(usable[i]);
+    }
+    return std::span{ret.data(), std::size_t(shapes)};
+  }
+
+  // binary_bfs for a rotation system chosen at runtime; pieces whose table equals the one of a piece in known
+  // (checked per piece, in order) run the compiled kernel, the others run binary_bfs_interpreted
+  template <coord start, typename board_t, typename... known>
+  class rule_engine {
+  public:
+    using result_t = static_vector<board_t, 4>;
+    explicit rule_engine(blocks::rotation_system rules): rules(std::move(rules)) {
+      for (std::size_t b = 0; b < 7; ++b) {
+        (void)(... || match<known>(block_type(b)));
+      }
+    }
+    result_t operator()(board_t data, block_type b, unsigned init_rot=0) const {
+      const auto &rule = rules[std::size_t(b)];
+      init_rot %= rule.orientations();
+      if (const auto kernel = kernels[std::size_t(b)][init_rot]) [[likely]] {
+        return kernel(data);
+      }
+      return binary_bfs_interpreted(data, rule, start, init_rot);
+    }
+    bool specialized(block_type b) const {
+      return kernels[std::size_t(b)][0] != nullptr;
+    }
+  private:
+    blocks::rotation_system rules;
+    std::array<std::array<result_t (*)(board_t), 4>, 7> kernels = {};
+    template <block B, std::size_t init_rot>
+    [[gnu::noinline]]
+    static result_t kernel(board_t data) {
+      auto ret = binary_bfs<B, start, init_rot>(data);
+      return std::span{ret};
+    }
+    template <typename RS>
+    bool match(block_type b) {
+      return call_with_block<RS>(b, [&]<block B>() {
+        if (blocks::to_runtime<B>() != rules[std::size_t(b)]) {
+          return false;
+        }
+        static_for<B.orientations>([&](auto i) {
+          kernels[std::size_t(b)][i] = &kernel<B, i>;
+        });
+        return true;
+      });
+    }
+  };
+}
@@ -1,25 +1,36 @@
 #pragma once
 #include "block.hpp"
+#include "stats.hpp"
 #include "utils.hpp"
 #include <tuple>
 #include <queue>
 #include <array>
 #include <type_traits>
 #include <span>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
 
-namespace reachability::search {
+namespace reachability::inline REACHABILITY_ISA::search {
   using namespace blocks;
+  // positions p whose cell p + cell is free, rows above the board count as free
+  template <coord cell, typename board_t>
+  constexpr board_t free_cells(board_t data) {
+    constexpr int x = cell[0_szc], y = cell[1_szc];
+    if constexpr (y > 0) {
+      return (~data.template move<coord{0, -y}>()).template move<coord{-x, 0}>();
+    } else {
+      return (~data).template move<-cell>();
+    }
+  }
   template <Wrap<mino_p> auto mino, typename board_t>
   constexpr board_t usable_positions(board_t data) {
     board_t positions = ~board_t();
     static_for<std::tuple_size_v<decltype(mino)>>([&][[gnu::always_inline]](auto i) {
-      constexpr auto move = mino[i];
-      constexpr int x = move[0_szc], y = move[1_szc];
-      if constexpr (y > 0) {
-        positions &= (~data.template move<coord{0, -y}>()).template move<coord{-x, 0}>();
-      } else {
-        positions &= (~data).template move<-move>();
-      }
+      positions &= free_cells<mino[i]>(data);
     });
     return positions;
   }
@@ -48,15 +59,103 @@ namespace reachability::search {
     }();
     return data.template move<d, need_mask>();
   }
-  template <block block, coord start, std::size_t init_rot, typename board_t>
-  constexpr std::array<board_t, block.shapes> binary_bfs(board_t data) {
+  enum class movement {
+    soft_drop, // moves, rotations and soft drop anywhere
+    hard_drop  // moves and rotations without going down by hand, then a hard drop
+  };
+  // occluded flood fill of current inside possible along rows, in log(W) steps
+  template <typename board_t>
+  constexpr board_t fill_horizontal(board_t current, board_t possible) {
+    board_t left = current, right = current, run_left = possible, run_right = possible;
+    static_for<std::bit_width(unsigned(board_t::width - 1))>([&][[gnu::always_inline]](auto k) {
+      constexpr int step = 1 << k;
+      left |= run_left & left.template move<coord{-step, 0}>();
+      run_left &= run_left.template move<coord{-step, 0}>();
+      right |= run_right & right.template move<coord{step, 0}>();
+      run_right &= run_right.template move<coord{step, 0}>();
+    });
+    return left | right;
+  }
+  // occluded flood fill of current inside possible downwards, in log(H) steps
+  template <typename board_t>
+  constexpr board_t fill_down(board_t current, board_t possible) {
+    static_for<std::bit_width(unsigned(board_t::height - 1))>([&][[gnu::always_inline]](auto k) {
+      constexpr int step = 1 << k;
+      current |= possible & current.template move<coord{0, -step}>();
+      possible &= possible.template move<coord{0, -step}>();
+    });
+    return current;
+  }
+  // rotate every position of orientation i with its kick table, growing the caches of the targets
+  template <block block, std::size_t i, typename board_t, std::size_t orientations>
+  [[gnu::always_inline]]
+  constexpr void apply_kicks(std::array<board_t, orientations> &cache, const board_t *usable, bool *need_visit, bool &updated) {
+    const stats::timer<stats::phase::kicks> timer;
+    constexpr auto index = index_c<block.mino_index[index_c<i>][0_szc]>;
+    static_for<std::tuple_size_v<decltype(block.kicks)>>([&][[gnu::always_inline]](auto j){
+      constexpr auto this_kick = block.kicks[j];
+      constexpr auto diff = this_kick[0_szc];
+      constexpr auto kick_table = this_kick[1_szc];
+      if constexpr (diff[0_szc] != i) {
+        return;
+      }
+      stats::count<&stats::call::kicks>(std::tuple_size_v<decltype(kick_table)>);
+      constexpr auto target = index_c<diff[1_szc]>;
+      board_t to = cache[target];
+      constexpr auto index2 = index_c<block.mino_index[target][0_szc]>;
+      board_t temp = cache[i];
+      static_for<std::tuple_size_v<decltype(kick_table)>>([&][[gnu::always_inline]](auto k){
+        to |= move_usable<block.minos[index], block.minos[index2], kick_table[k]>(temp);
+        temp &= ~move_usable<block.minos[index2], block.minos[index], -kick_table[k]>(usable[index2]);
+      });
+      to &= usable[index2];
+      if (!cache[target].contains(to)) {
+        need_visit[target] = true;
+        if constexpr (target < i)
+          updated = true;
+      }
+      cache[target] = to;
+    });
+  }
+  // hard_drop model: the closure only uses horizontal moves and rotations, which never leave the rows
+  // around the spawn except through kicks, then every reached position falls straight down
+  template <block block, typename board_t>
+  [[gnu::always_inline]]
+  constexpr std::array<board_t, block.shapes> hard_drop_closure(const board_t *usable, std::array<board_t, block.orientations> &cache, bool *need_visit) {
     constexpr int orientations = block.orientations;
     constexpr int shapes = block.shapes;
-    board_t usable[shapes];
-    static_for<shapes>([&][[gnu::always_inline]](auto i) {
-      usable[i] = usable_positions<block.minos[i]>(data);
+    for (bool updated = true; updated;) {
+      updated = false;
+      stats::count<&stats::call::outer>();
+      static_for<orientations>([&][[gnu::always_inline]](auto i){
+        if (!need_visit[i]) {
+          return;
+        }
+        constexpr auto index = block.mino_index[i][0_szc];
+        need_visit[i] = false;
+        {
+          const stats::timer<stats::phase::closure> timer;
+          cache[i] = fill_horizontal(cache[i], usable[index]);
+          stats::count<&stats::call::inner>();
+        }
+        apply_kicks<block, i>(cache, usable, need_visit, updated);
+      });
+    }
+    const stats::timer<stats::phase::landable> timer;
+    std::array<board_t, shapes> ret;
+    static_for<orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret[index] |= fill_down(cache[i], usable[index]);
     });
-    constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    static_for<shapes>([&][[gnu::always_inline]](auto i){
+      ret[i] &= landable_positions(usable[i]);
+    });
+    return ret;
+  }
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  constexpr std::array<board_t, block.shapes> binary_bfs_hard_drop(const board_t *usable) {
+    const stats::call_scope scope;
+    constexpr int orientations = block.orientations;
     constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
     constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
     if (!usable[init_rot2].template get<start2[0_szc], start2[1_szc]>()) [[unlikely]] {
@@ -65,8 +164,74 @@ namespace reachability::search {
     bool need_visit[orientations] = { };
     need_visit[init_rot] = true;
     std::array<board_t, orientations> cache;
+    cache[init_rot].template set<start2[0_szc], start2[1_szc]>();
+    return hard_drop_closure<block>(usable, cache, need_visit);
+  }
+  enum class closure {
+    step,    // one cell in every direction per iteration
+    log_step // occluded fills of log(W) and log(H) shifts, repeated only from the bits the last fill added
+  };
+  // grow cache to the fixed point of moves, soft drop and rotations, starting from the orientations in need_visit
+  // if steps is given, every iteration of the move closure adds one to it
+  template <block block, closure kind=closure::step, typename board_t>
+  [[gnu::always_inline]]
+  constexpr void expand_closure(const board_t *usable, std::array<board_t, block.orientations> &cache, bool *need_visit, int *steps = nullptr) {
+    constexpr int orientations = block.orientations;
+    constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    for (bool updated = true; updated;) [[unlikely]] {
+      updated = false;
+      stats::count<&stats::call::outer>();
+      static_for<orientations>([&][[gnu::always_inline]](auto i){
+        if (!need_visit[i]) {
+          return;
+        }
+        constexpr auto index = index_c<block.mino_index[i][0_szc]>;
+        need_visit[i] = false;
+        {
+          const stats::timer<stats::phase::closure> timer;
+          if constexpr (kind == closure::log_step) {
+            // across is closed sideways and down is closed downwards, so only the bits that were reached
+            // by falling alone can still spread, and a round that adds none of them is the last one
+            board_t frontier = cache[i];
+            do {
+              const board_t across = fill_horizontal(frontier, usable[index]);
+              const board_t down = fill_down(across, usable[index]);
+              frontier = down & ~across & ~cache[i];
+              cache[i] |= down;
+              if (steps) ++*steps;
+              stats::count<&stats::call::inner>();
+            } while (frontier.any());
+          } else {
+            while (true) {
+              board_t result = cache[i];
+              static_for<MOVES.size()>([&][[gnu::always_inline]](auto j) {
+                result |= move_usable<block.minos[index], block.minos[index], MOVES[j]>(cache[i]);
+              });
+              result &= usable[index];
+              if (steps) ++*steps;
+              stats::count<&stats::call::inner>();
+              if (cache[i].contains(result)) [[unlikely]] {
+                break;
+              }
+              cache[i] = result;
+            }
+          }
+        }
+        apply_kicks<block, i>(cache, usable, need_visit, updated);
+      });
+    }
+  }
+  // positions reachable from start without rotating, as far as they can be found without iterating:
+  // every line above the stack where the piece can move freely, or only start itself
+  // usable[init_rot2] must contain start
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  [[gnu::always_inline]]
+  constexpr board_t spawn_positions(const board_t *usable) {
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
     const auto consecutive = consecutive_lines(usable[init_rot2]);
     if (consecutive.template get<start2[1_szc]>()) [[likely]] {
+      stats::mark<&stats::call::fast_path>();
       const auto current = usable[init_rot2] & usable[init_rot2].template move<coord{0, -1}>();
       const auto covered = usable[init_rot2] & ~current;
       const auto expandable = can_expand(current, covered);
@@ -79,25 +244,483 @@ namespace reachability::search {
       if constexpr (removed_lines > 1) {
         good_lines &= (~board_t()).template move<coord{0, -(removed_lines - 1)}>();
       }
-      cache[init_rot] = good_lines & usable[init_rot2];
+      return good_lines & usable[init_rot2];
     } else {
-      cache[init_rot].template set<start2[0_szc], start2[1_szc]>();
+      board_t ret;
+      ret.template set<start2[0_szc], start2[1_szc]>();
+      return ret;
     }
-    for (bool updated = true; updated;) [[unlikely]] {
-      updated = false;
+  }
+  // every position reachable from start with moves, soft drop and rotations, per orientation
+  // returns false (leaving cache empty) if the spawn position is blocked, steps as in expand_closure
+  template <block block, coord start, std::size_t init_rot, closure kind=closure::step, typename board_t>
+  [[gnu::always_inline]]
+  constexpr bool soft_drop_closure(const board_t *usable, std::array<board_t, block.orientations> &cache, int *steps = nullptr) {
+    constexpr int orientations = block.orientations;
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
+    if (!usable[init_rot2].template get<start2[0_szc], start2[1_szc]>()) [[unlikely]] {
+      return false;
+    }
+    bool need_visit[orientations] = { };
+    need_visit[init_rot] = true;
+    {
+      const stats::timer<stats::phase::init> timer;
+      cache[init_rot] = spawn_positions<block, start, init_rot>(usable);
+    }
+    expand_closure<block, kind>(usable, cache, need_visit, steps);
+    return true;
+  }
+  // runtime counterpart of spawn_positions, usable must contain (x, y)
+  template <typename board_t>
+  constexpr board_t spawn_positions(board_t usable, int x, int y) {
+    const auto consecutive = consecutive_lines(usable);
+    if (consecutive.get(board_t::width - 1, y)) [[likely]] {
+      stats::mark<&stats::call::fast_path>();
+      const auto current = usable & usable.template move<coord{0, -1}>();
+      const auto covered = usable & ~current;
+      const auto expandable = can_expand(current, covered);
+      auto whole_line_usable = (expandable | ~covered.get_heads()).all_bits().populate_highest_bit();
+      if (y < board_t::height) {
+        whole_line_usable |= board_t::lines(~std::uint64_t(0) << y);
+      }
+      auto good_lines = whole_line_usable.remove_ones_after_zero();
+      if (y < board_t::height - 1) {
+        good_lines &= board_t::lines((std::uint64_t(2) << y) - 1);
+      }
+      return good_lines & usable;
+    } else {
+      board_t ret;
+      ret.set(x, y);
+      return ret;
+    }
+  }
+  // orientation init_rot of block known only at runtime: its shape and the spawn moved by its offset
+  template <block block>
+  constexpr std::array<int, 3> spawn_of(coord start, unsigned init_rot) {
+    std::array<int, 3> ret = {};
+    static_for<block.orientations>([&][[gnu::always_inline]](auto i) {
+      if (i == init_rot) {
+        constexpr coord offset = block.mino_index[i][1_szc];
+        ret = {block.mino_index[i][0_szc], start[0_szc] + offset[0_szc], start[1_szc] + offset[1_szc]};
+      }
+    });
+    return ret;
+  }
+  // soft_drop_closure with start and init_rot (less than block.orientations) known only at runtime,
+  // they only choose the seed so the closure itself is the compiled one; a spawn outside the board counts as blocked
+  template <block block, typename board_t>
+  [[gnu::always_inline]]
+  constexpr bool soft_drop_closure(const board_t *usable, std::array<board_t, block.orientations> &cache, coord start, unsigned init_rot) {
+    const auto [init_rot2, x, y] = spawn_of<block>(start, init_rot);
+    if (usable[init_rot2].get(x, y) != 1) [[unlikely]] {
+      return false;
+    }
+    bool need_visit[block.orientations] = { };
+    need_visit[init_rot] = true;
+    {
+      const stats::timer<stats::phase::init> timer;
+      cache[init_rot] = spawn_positions(usable[init_rot2], x, y);
+    }
+    expand_closure<block>(usable, cache, need_visit);
+    return true;
+  }
+  // binary_bfs from already computed usable positions of every shape
+  template <block block, coord start, std::size_t init_rot, movement model=movement::soft_drop, closure kind=closure::step, typename board_t>
+  constexpr std::array<board_t, block.shapes> binary_bfs_usable(const board_t *usable) {
+    const stats::call_scope scope;
+    if constexpr (model == movement::hard_drop) {
+      return binary_bfs_hard_drop<block, start, init_rot>(usable);
+    }
+    constexpr int orientations = block.orientations;
+    constexpr int shapes = block.shapes;
+    std::array<board_t, orientations> cache;
+    if (!soft_drop_closure<block, start, init_rot, kind>(usable, cache)) [[unlikely]] {
+      return {};
+    }
+    const stats::timer<stats::phase::landable> timer;
+    std::array<board_t, shapes> ret;
+    static_for<orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret[index] |= cache[i];
+    });
+    static_for<shapes>([&][[gnu::always_inline]](auto i){
+      ret[i] &= landable_positions(usable[i]);
+    });
+    return ret;
+  }
+  namespace details {
+    template <block block>
+    constexpr int highest_kick_dy = []{
+      int ret = 0;
+      static_for<std::tuple_size_v<decltype(block.kicks)>>([&](auto j) {
+        constexpr auto kick_table = block.kicks[j][1_szc];
+        static_for<std::tuple_size_v<decltype(kick_table)>>([&](auto k) {
+          ret = std::max(ret, std::abs(int(kick_table[k][1_szc])));
+        });
+      });
+      return ret;
+    }();
+    // a position with a cell below the stack top is entered from one at most a piece and a kick higher
+    template <block block>
+    constexpr int window_band = 4 + highest_kick_dy<block>;
+    // rows a window needs above the stack top to hold every position of the band,
+    // the board above it is open like the rows above any board
+    template <block block>
+    constexpr int window_margin = []{
+      int lowest_cell = 0;
+      static_for<block.shapes>([&](auto i) {
+        lowest_cell = std::min(lowest_cell, blocks::mino_range<block.minos[i]>()[1]);
+      });
+      return window_band<block> - lowest_cell;
+    }();
+    // only boards that take more than one register gain from a window
+    template <block block, coord start, std::size_t init_rot, typename board_t>
+    constexpr bool windowed = []{
+      if constexpr (!requires { typename board_t::template with_height<1>; }) {
+        return false;
+      } else if constexpr (board_t::num_of_under <= board_t::native_words) {
+        return false;
+      } else {
+        constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+        constexpr auto range = blocks::mino_range<block.minos[index_c<block.mino_index[index_c<init_rot>][0_szc]>]>();
+        constexpr int words = (window_margin<block> + board_t::lines_per_under - 1) / board_t::lines_per_under;
+        return start2[0_szc] + range[0] >= 0 && start2[0_szc] + range[2] < board_t::width
+          && start2[1_szc] + range[1] >= window_band<block> && start2[1_szc] + range[3] < board_t::height
+          && words < board_t::num_of_under;
+      }
+    }();
+  }
+  // binary_bfs on the lowest words of a tall board with a low stack, in at most one register; false if the stack
+  // is too high for that. every position between the stack and the spawn is reachable through the open rows,
+  // so the positions of the band right above the stack seed the closure, and like any board the window is open
+  // above its top row, which the rest of the real board is as well
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  constexpr bool binary_bfs_window(board_t data, std::array<board_t, block.shapes> &ret) {
+    constexpr int orientations = block.orientations;
+    constexpr int lines_per_under = board_t::lines_per_under;
+    constexpr int band = details::window_band<block>;
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr int spawn_low = start2[1_szc] + blocks::mino_range<block.minos[index_c<block.mino_index[index_c<init_rot>][0_szc]>]>()[1];
+    const int top = std::bit_width(data.any_bit().populate_highest_bit().full_rows());
+    if (spawn_low < top + band) {
+      return false;
+    }
+    bool done = false;
+    static_for<board_t::num_of_under - 1>([&][[gnu::always_inline]](auto k) {
+      constexpr int rows = (k + 1) * lines_per_under;
+      if constexpr (rows >= details::window_margin<block> && k < board_t::native_words) {
+        if (done || top + details::window_margin<block> > rows) {
+          return;
+        }
+        done = true;
+        stats::mark<&stats::call::windowed>();
+        using window_t = typename board_t::template with_height<rows>;
+        const auto words = data.to_array();
+        window_t usable[block.shapes];
+        {
+          const stats::timer<stats::phase::usable> timer;
+          decltype(window_t().to_array()) window_words;
+          std::copy_n(words.begin(), window_words.size(), window_words.begin());
+          const window_t window = window_words;
+          static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+            usable[i] = usable_positions<block.minos[i]>(window);
+          });
+        }
+        std::array<window_t, orientations> cache;
+        bool need_visit[orientations];
+        {
+          const stats::timer<stats::phase::init> timer;
+          static_for<orientations>([&][[gnu::always_inline]](auto i) {
+            constexpr auto index = index_c<block.mino_index[i][0_szc]>;
+            const int from = std::max(top - blocks::mino_range<block.minos[index]>()[1], 0);
+            cache[i] = usable[index] & window_t::lines(~std::uint64_t(0) << from & ~(~std::uint64_t(0) << (from + band)));
+            need_visit[i] = true;
+          });
+        }
+        expand_closure<block>(usable, cache, need_visit);
+        const stats::timer<stats::phase::landable> timer;
+        std::array<window_t, block.shapes> landable;
+        static_for<orientations>([&][[gnu::always_inline]](auto i) {
+          landable[block.mino_index[i][0_szc]] |= cache[i];
+        });
+        static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+          const auto result = (landable[i] & landable_positions(usable[i])).to_array();
+          auto full = decltype(words){};
+          std::copy(result.begin(), result.end(), full.begin());
+          ret[i] = full;
+        });
+      }
+    });
+    return done;
+  }
+  template <block block, coord start, std::size_t init_rot, movement model=movement::soft_drop, closure kind=closure::step, typename board_t>
+  constexpr std::array<board_t, block.shapes> binary_bfs(board_t data) {
+    const stats::call_scope scope;
+    if constexpr (model == movement::soft_drop && kind == closure::step && details::windowed<block, start, init_rot, board_t>) {
+      std::array<board_t, block.shapes> ret;
+      if (binary_bfs_window<block, start, init_rot>(data, ret)) {
+        return ret;
+      }
+    }
+    board_t usable[block.shapes];
+    {
+      const stats::timer<stats::phase::usable> timer;
+      static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+        usable[i] = usable_positions<block.minos[i]>(data);
+      });
+    }
+    return binary_bfs_usable<block, start, init_rot, model, kind>(usable);
+  }
+  template <typename RS, coord start, unsigned init_rot=0, movement model=movement::soft_drop, typename board_t>
+  [[gnu::noinline]]
+  constexpr static_vector<board_t, 4> binary_bfs(board_t data, block_type b) {
+    return call_with_block<RS>(b, [=]<block B>() {
+      auto ret = binary_bfs<B, start, init_rot % B.orientations, model>(data);
+      return static_vector<board_t, 4>{std::span{ret}};
+    });
+  }
+  // binary_bfs with start and init_rot known only at runtime, init_rot wraps around like in the RS overload
+  template <block block, movement model=movement::soft_drop, typename board_t>
+  constexpr std::array<board_t, block.shapes> binary_bfs(board_t data, coord start, unsigned init_rot) {
+    const stats::call_scope scope;
+    constexpr int orientations = block.orientations;
+    constexpr int shapes = block.shapes;
+    board_t usable[shapes];
+    {
+      const stats::timer<stats::phase::usable> timer;
+      static_for<shapes>([&][[gnu::always_inline]](auto i) {
+        usable[i] = usable_positions<block.minos[i]>(data);
+      });
+    }
+    init_rot %= orientations;
+    std::array<board_t, orientations> cache;
+    if constexpr (model == movement::hard_drop) {
+      const auto [init_rot2, x, y] = spawn_of<block>(start, init_rot);
+      if (usable[init_rot2].get(x, y) != 1) [[unlikely]] {
+        return {};
+      }
+      bool need_visit[orientations] = { };
+      need_visit[init_rot] = true;
+      cache[init_rot].set(x, y);
+      return hard_drop_closure<block>(usable, cache, need_visit);
+    }
+    if (!soft_drop_closure<block>(usable, cache, start, init_rot)) [[unlikely]] {
+      return {};
+    }
+    const stats::timer<stats::phase::landable> timer;
+    std::array<board_t, shapes> ret;
+    static_for<orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret[index] |= cache[i];
+    });
+    static_for<shapes>([&][[gnu::always_inline]](auto i){
+      ret[i] &= landable_positions(usable[i]);
+    });
+    return ret;
+  }
+  // spawns x in [min_x, max_x], y in [min_y, max_y] with init_rot in [0, 4) that get a kernel of their own
+  template <int min_x, int max_x, int min_y, int max_y>
+  struct spawn_range {
+    static constexpr int columns = max_x - min_x + 1;
+    static constexpr int rows = max_y - min_y + 1;
+    static constexpr int size = columns * rows * 4;
+    static_assert(columns > 0 && rows > 0);
+    // index of the kernel, or -1 if the spawn is not in the range
+    static constexpr int index_of(coord start, unsigned init_rot) {
+      const int x = start[0_szc] - min_x, y = start[1_szc] - min_y;
+      if (x < 0 || x >= columns || y < 0 || y >= rows || init_rot >= 4) {
+        return -1;
+      }
+      return (int(init_rot) * rows + y) * columns + x;
+    }
+    static constexpr coord start_of(int index) {
+      return {index % columns + min_x, index / columns % rows + min_y};
+    }
+    static constexpr unsigned rotation_of(int index) {
+      return index / (columns * rows);
+    }
+  };
+  namespace details {
+    template <typename RS, block_type b, coord start, unsigned init_rot, movement model, typename board_t>
+    static_vector<board_t, 4> spawn_kernel(board_t data) {
+      return call_with_block<RS>(b, [=]<block B>() {
+        auto ret = binary_bfs<B, start, init_rot % B.orientations, model>(data);
+        return static_vector<board_t, 4>{std::span{ret}};
+      });
+    }
+  }
+  // runtime spawn and rotation: spawns in the range jump through a table of specialized kernels
+  // (one indexed load, like the jump table of call_with_block), the others run the runtime seeded kernel
+  template <typename RS, typename spawns, movement model=movement::soft_drop, typename board_t>
+  [[gnu::noinline]]
+  static_vector<board_t, 4> binary_bfs(board_t data, block_type b, coord start, unsigned init_rot) {
+    using kernel_t = static_vector<board_t, 4> (*)(board_t);
+    static constexpr auto kernels = []{
+      std::array<kernel_t, 7 * spawns::size> ret;
+      static_for<7 * spawns::size>([&](auto i) {
+        constexpr int index = i % spawns::size;
+        ret[i] = details::spawn_kernel<RS, block_type(i / spawns::size), spawns::start_of(index), spawns::rotation_of(index), model, board_t>;
+      });
+      return ret;
+    }();
+    const int index = spawns::index_of(start, init_rot);
+    if (index >= 0) [[likely]] {
+      return kernels[std::size_t(b) * spawns::size + index](data);
+    }
+    return call_with_block<RS>(b, [=]<block B>() {
+      auto ret = binary_bfs<B, model>(data, start, init_rot);
+      return static_vector<board_t, 4>{std::span{ret}};
+    });
+  }
+  // every distinct mino cell of the blocks of RS
+  template <typename RS>
+  constexpr auto mino_cells = []{
+    std::array<std::array<int, 2>, 7 * 4 * 4> cells = {};
+    std::size_t count = 0;
+    using enum block_type;
+    for (const auto b : {T, Z, S, J, L, O, I}) {
+      call_with_block<RS>(b, [&]<block B>() {
+        static_for<B.shapes>([&](auto i) {
+          static_for<std::tuple_size_v<std::remove_cvref_t<decltype(B.minos[i])>>>([&](auto j) {
+            const std::array<int, 2> cell = {B.minos[i][j][0_szc], B.minos[i][j][1_szc]};
+            if (std::find(cells.begin(), cells.begin() + count, cell) == cells.begin() + count) {
+              cells[count++] = cell;
+            }
+          });
+        });
+      });
+    }
+    return std::pair{cells, count};
+  }();
+  // free_cells of ~data for the mino cells used by a set of pieces of RS, every cell is shifted once
+  // however many shapes of those pieces use it (most of them share (0, 0) and its neighbours)
+  template <typename RS, typename board_t>
+  class shifted_boards {
+  public:
+    constexpr shifted_boards(board_t data, std::span<const block_type> blocks) {
+      std::uint64_t needed = 0;
+      for (const auto b : blocks) {
+        needed |= cells_of[std::size_t(b)];
+      }
+      static_for<cells.second>([&][[gnu::always_inline]](auto i) {
+        if (needed >> i & 1) {
+          shifted[i] = search::free_cells<coord{cells.first[i][0], cells.first[i][1]}>(data);
+        }
+      });
+    }
+    template <Wrap<mino_p> auto mino>
+    constexpr board_t usable_positions() const {
+      board_t positions = ~board_t();
+      static_for<std::tuple_size_v<decltype(mino)>>([&][[gnu::always_inline]](auto i) {
+        constexpr std::size_t index = index_of(mino[i][0_szc], mino[i][1_szc]);
+        positions &= shifted[index];
+      });
+      return positions;
+    }
+  private:
+    static constexpr auto cells = mino_cells<RS>;
+    static_assert(cells.second <= 64);
+    static constexpr std::size_t index_of(int x, int y) {
+      return std::find(cells.first.begin(), cells.first.end(), std::array<int, 2>{x, y}) - cells.first.begin();
+    }
+    // bit i is set iff the block uses cells.first[i]
+    static constexpr auto cells_of = []{
+      std::array<std::uint64_t, 7> ret = {};
+      using enum block_type;
+      for (const auto b : {T, Z, S, J, L, O, I}) {
+        call_with_block<RS>(b, [&]<block B>() {
+          static_for<B.shapes>([&](auto i) {
+            static_for<std::tuple_size_v<std::remove_cvref_t<decltype(B.minos[i])>>>([&](auto j) {
+              ret[std::size_t(b)] |= std::uint64_t(1) << index_of(B.minos[i][j][0_szc], B.minos[i][j][1_szc]);
+            });
+          });
+        });
+      }
+      return ret;
+    }();
+    std::array<board_t, cells.second> shifted;
+  };
+  // landable positions of several pieces on one board, indexed by block_type (pieces not asked for stay empty)
+  template <typename board_t>
+  using piece_results = std::array<std::array<board_t, 4>, 7>;
+  template <typename RS, coord start, unsigned init_rot=0, movement model=movement::soft_drop, typename board_t>
+  [[gnu::noinline]]
+  piece_results<board_t> binary_bfs_pieces(board_t data, std::span<const block_type> blocks) {
+    piece_results<board_t> ret;
+    const shifted_boards<RS, board_t> shifted(data, blocks);
+    for (const auto b : blocks) {
+      call_with_block<RS>(b, [&]<block B>() {
+        board_t usable[B.shapes];
+        static_for<B.shapes>([&][[gnu::always_inline]](auto i) {
+          usable[i] = shifted.template usable_positions<B.minos[i]>();
+        });
+        const auto result = binary_bfs_usable<B, start, init_rot % B.orientations, model>(usable);
+        std::copy(result.begin(), result.end(), ret[std::size_t(b)].begin());
+      });
+    }
+    return ret;
+  }
+  // binary_bfs on a board_batch_t: every lane runs the same fixed-point loop in lockstep,
+  // need_visit tracks per-lane convergence and lanes that already converged just stay unchanged
+  template <block block, coord start, std::size_t init_rot, typename batch_t>
+  constexpr std::array<batch_t, block.shapes> binary_bfs_batch(batch_t data) {
+    using mask_t = typename batch_t::mask_t;
+    constexpr int orientations = block.orientations;
+    constexpr int shapes = block.shapes;
+    batch_t usable[shapes];
+    static_for<shapes>([&][[gnu::always_inline]](auto i) {
+      usable[i] = usable_positions<block.minos[i]>(data);
+    });
+    constexpr std::array<coord, 3> MOVES = {{{-1, 0}, {1, 0}, {0, -1}}};
+    constexpr coord start2 = start + block.mino_index[index_c<init_rot>][1_szc];
+    constexpr auto init_rot2 = block.mino_index[index_c<init_rot>][0_szc];
+    const mask_t alive = usable[init_rot2].template get<start2[0_szc], start2[1_szc]>();
+    if (none_of(alive)) [[unlikely]] {
+      return {};
+    }
+    mask_t need_visit[orientations];
+    static_for<orientations>([&][[gnu::always_inline]](auto i) {
+      need_visit[i] = i == init_rot ? alive : mask_t(false);
+    });
+    std::array<batch_t, orientations> cache;
+    batch_t single;
+    single.template set<start2[0_szc], start2[1_szc]>();
+    const auto consecutive = consecutive_lines(usable[init_rot2]);
+    const mask_t fast = alive && consecutive.template get<start2[1_szc]>();
+    if (any_of(fast)) [[likely]] {
+      const auto current = usable[init_rot2] & usable[init_rot2].template move<coord{0, -1}>();
+      const auto covered = usable[init_rot2] & ~current;
+      const auto expandable = can_expand(current, covered);
+      auto whole_line_usable = (expandable | ~covered.get_heads()).all_bits().populate_highest_bit();
+      constexpr int removed_lines = batch_t::height - start2[1_szc];
+      if constexpr (removed_lines > 0) {
+        whole_line_usable |= ~(~batch_t()).template move<coord{0, -removed_lines}>();
+      }
+      auto good_lines = whole_line_usable.remove_ones_after_zero();
+      if constexpr (removed_lines > 1) {
+        good_lines &= (~batch_t()).template move<coord{0, -(removed_lines - 1)}>();
+      }
+      cache[init_rot] = batch_t::select(fast, good_lines & usable[init_rot2], single);
+    } else {
+      cache[init_rot] = single;
+    }
+    cache[init_rot] = batch_t::select(alive, cache[init_rot], batch_t());
+    for (mask_t updated = alive; any_of(updated);) [[unlikely]] {
+      updated = mask_t(false);
       static_for<orientations>([&][[gnu::always_inline]](auto i){
-        if (!need_visit[i]) {
+        if (none_of(need_visit[i])) {
           return;
         }
         constexpr auto index = index_c<block.mino_index[i][0_szc]>;
-        need_visit[i] = false;
+        need_visit[i] = mask_t(false);
         while (true) {
-          board_t result = cache[i];
+          batch_t result = cache[i];
           static_for<MOVES.size()>([&][[gnu::always_inline]](auto j) {
             result |= move_usable<block.minos[index], block.minos[index], MOVES[j]>(cache[i]);
           });
           result &= usable[index];
-          if (cache[i].contains(result)) [[unlikely]] {
+          if (all_of(cache[i].contains(result))) [[unlikely]] {
             break;
           }
           cache[i] = result;
@@ -110,24 +733,23 @@ namespace reachability::search {
             return;
           }
           constexpr auto target = index_c<diff[1_szc]>;
-          board_t to = cache[target];
+          batch_t to = cache[target];
           constexpr auto index2 = index_c<block.mino_index[target][0_szc]>;
-          board_t temp = cache[i];
+          batch_t temp = cache[i];
           static_for<std::tuple_size_v<decltype(kick_table)>>([&][[gnu::always_inline]](auto k){
             to |= move_usable<block.minos[index], block.minos[index2], kick_table[k]>(temp);
             temp &= ~move_usable<block.minos[index2], block.minos[index], -kick_table[k]>(usable[index2]);
           });
           to &= usable[index2];
-          if (!cache[target].contains(to)) {
-            need_visit[target] = true;
-            if constexpr (target < i)
-              updated = true;
-          }
+          const mask_t grown = !cache[target].contains(to);
+          need_visit[target] = need_visit[target] || grown;
+          if constexpr (target < i)
+            updated = updated || grown;
           cache[target] = to;
         });
       });
     }
-    std::array<board_t, shapes> ret;
+    std::array<batch_t, shapes> ret;
     static_for<orientations>([&][[gnu::always_inline]](auto i){
       constexpr auto index = block.mino_index[i][0_szc];
       ret[index] |= cache[i];
@@ -137,87 +759,123 @@ namespace reachability::search {
     });
     return ret;
   }
-  template <typename RS, coord start, unsigned init_rot=0, typename board_t>
+  template <typename RS, coord start, unsigned init_rot=0, typename batch_t>
   [[gnu::noinline]]
-  constexpr static_vector<board_t, 4> binary_bfs(board_t data, block_type b) {
+  constexpr static_vector<batch_t, 4> binary_bfs_batch(batch_t data, block_type b) {
     return call_with_block<RS>(b, [=]<block B>() {
-      auto ret = binary_bfs<B, start, init_rot>(data);
-      return static_vector<board_t, 4>{std::span{ret}};
+      auto ret = binary_bfs_batch<B, start, init_rot % B.orientations>(data);
+      return static_vector<batch_t, 4>{std::span{ret}};
     });
   }
-  template <typename board_t>
-  auto ordinary_bfs_without_binary(board_t data, const auto &block, const coord &start, unsigned init_rot) {
-    constexpr auto orientations = std::remove_cvref_t<decltype(block)>::ORIENTATIONS;
-    constexpr auto shapes = std::remove_cvref_t<decltype(block)>::SHAPES;
-    constexpr auto W = board_t::width;
-    constexpr auto H = board_t::height;
-    bool my_data[H][W];
-    static_for<H>([&][[gnu::always_inline]](auto y) {
-      static_for<W>([&][[gnu::always_inline]](auto x) {
-        my_data[y][x] = data.template get<x, y>();
-      });
-    });
-    auto in_range = [](int x, int y) {
-      return 0 <= x && unsigned(x) < W && 0 <= y && unsigned(y) < H;
+  // one position at a time, to check binary_bfs against: a position of an orientation is the origin of its shape
+  // inside the board with every cell free (rows above the board count as free), moves go left, right and (with
+  // soft drop) down, a rotation takes the first kick that lands on a usable position, and with hard drop every
+  // reached position falls straight down. the spawn is given like in the runtime binary_bfs
+  template <block block, movement model=movement::soft_drop, typename board_t>
+  std::array<board_t, block.shapes> ordinary_bfs_without_binary(board_t data, coord start, unsigned init_rot) {
+    constexpr int orientations = block.orientations;
+    constexpr int W = board_t::width;
+    constexpr int H = board_t::height;
+    // the block as plain tables
+    std::array<std::vector<coord>, block.shapes> cells;
+    static_for<block.shapes>([&](auto i) {
+      static_for<std::tuple_size_v<std::remove_cvref_t<decltype(block.minos[i])>>>([&](auto j) {
+        cells[i].push_back(block.minos[i][j]);
+      });
+    });
+    std::array<int, orientations> shape;
+    std::array<coord, orientations> offset;
+    static_for<orientations>([&](auto i) {
+      shape[i] = block.mino_index[i][0_szc];
+      offset[i] = block.mino_index[i][1_szc];
+    });
+    struct kick {
+      int from, to;
+      std::vector<coord> offsets;
     };
-    auto usable = [&](int i, int x, int y) {
-      const auto index = block.mino_index[i];
-      for (const auto &[dx, dy] : block.minos[index]) {
-        if (!in_range(x + dx, y + dy)) return false;
-        if (my_data[y + dy][x + dx]) return false;
+    std::vector<kick> kicks;
+    static_for<std::tuple_size_v<decltype(block.kicks)>>([&](auto j) {
+      constexpr auto diff = block.kicks[j][0_szc];
+      constexpr auto kick_table = block.kicks[j][1_szc];
+      kick k{diff[0_szc], diff[1_szc], {}};
+      static_for<std::tuple_size_v<decltype(kick_table)>>([&](auto l) {
+        k.offsets.push_back(kick_table[l]);
+      });
+      kicks.push_back(k);
+    });
+    const auto usable = [&](int i, int x, int y) {
+      if (x < 0 || x >= W || y < 0 || y >= H) {
+        return false;
+      }
+      for (const auto &cell : cells[shape[i]]) {
+        const int cx = x + cell[0_szc], cy = y + cell[1_szc];
+        if (cx < 0 || cx >= W || cy < 0 || (cy < H && data.get(cx, cy))) {
+          return false;
+        }
       }
       return true;
     };
-    constexpr const coord MOVES[] = {{0, -1}, {-1, 0}, {1, 0}};
-    bool visited[orientations][H][W] = {};
-    bool ret[orientations][H][W] = {};
-    std::queue<std::tuple<int, int, int>> q;
-    auto visit = [&] [[gnu::always_inline]] (int i, int x, int y) {
-      if (!in_range(x, y) || !usable(i, x, y))
+    std::vector<std::uint8_t> visited(orientations * W * H);
+    std::queue<std::array<int, 3>> q;
+    const auto visit = [&](int i, int x, int y) {
+      if (!usable(i, x, y)) {
         return false;
-      if (!visited[i][y][x]) {
-        visited[i][y][x] = true;
-        q.emplace(x, y, i);
-        if (!usable(i, x, y - 1))
-          ret[i][y][x] = true;
+      }
+      auto &seen = visited[(i * H + y) * W + x];
+      if (!seen) {
+        seen = true;
+        q.push({i, x, y});
       }
       return true;
     };
-    const auto start2 = start + block.mino_offset[init_rot];
-    visit(init_rot, start2[0], start2[1]);
+    init_rot %= orientations;
+    std::array<board_t, block.shapes> ret;
+    if (!visit(init_rot, start[0_szc] + offset[init_rot][0_szc], start[1_szc] + offset[init_rot][1_szc])) {
+      return ret;
+    }
+    constexpr int moves = model == movement::soft_drop ? 3 : 2;
+    constexpr coord MOVES[] = {{-1, 0}, {1, 0}, {0, -1}};
     while (!q.empty()) {
-      const auto [x, y, i] = q.front();
+      const auto [i, x, y] = q.front();
       q.pop();
-      for (auto &[dx, dy] : MOVES) {
-          visit(i, x + dx, y + dy);
+      for (int m = 0; m < moves; ++m) {
+        visit(i, x + MOVES[m][0_szc], y + MOVES[m][1_szc]);
       }
-      for (int j = 0; j < block.ROTATIONS; ++j) {
-        const auto target = block.rotation_target(i, j);
-        for (auto &[dx, dy] : block.kicks[i][j]) {
-          if (visit(target, x + dx, y + dy)) {
+      for (const auto &k : kicks) {
+        if (k.from != i) {
+          continue;
+        }
+        for (const auto &d : k.offsets) {
+          if (visit(k.to, x + d[0_szc], y + d[1_szc])) {
             break;
           }
         }
       }
     }
-    std::array<board_t, shapes> true_ret;
-    static_for<orientations>([&][[gnu::always_inline]](auto i) {
-      auto index = block.mino_index[i];
-      static_for<H>([&][[gnu::always_inline]](auto y) {
-        static_for<W>([&][[gnu::always_inline]](auto x) {
-          if (ret[i][y][x]) {
-            true_ret[index].template set<x, y>();
+    for (int i = 0; i < orientations; ++i) {
+      for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+          if (!visited[(i * H + y) * W + x]) {
+            continue;
           }
-        });
-      });
-    });
-    return true_ret;
+          int landing = y;
+          if constexpr (model == movement::hard_drop) {
+            while (usable(i, x, landing - 1)) {
+              --landing;
+            }
+          } else if (usable(i, x, y - 1)) {
+            continue;
+          }
+          ret[shape[i]].set(x, landing);
+        }
+      }
+    }
+    return ret;
   }
-  template <typename RS, typename board_t>
-  [[gnu::noinline]]
-  constexpr static_vector<board_t, 4> ordinary_bfs_without_binary(board_t data, block_type b, const coord &start, unsigned init_rot=0) {
+  template <typename RS, movement model=movement::soft_drop, typename board_t>
+  static_vector<board_t, 4> ordinary_bfs_without_binary(board_t data, block_type b, coord start, unsigned init_rot=0) {
     return call_with_block<RS>(b, [=]<block B>() {
-      auto ret = ordinary_bfs_without_binary(data, B, start, init_rot);
+      auto ret = ordinary_bfs_without_binary<B, model>(data, start, init_rot);
       return static_vector<board_t, 4>{std::span{ret}};
     });
   }
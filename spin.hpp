@@ -0,0 +1,139 @@
+#pragma once
+#include "block.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+
+// spin information for whole bitboards of landing positions.
+// everything is per orientation and in the same coordinates as the landable boards of binary_bfs.
+namespace reachability::inline REACHABILITY_ISA::search {
+  template <block block, typename board_t>
+  struct spin_result {
+    static constexpr int orientations = block.orientations;
+    static constexpr int shapes = block.shapes;
+    std::array<board_t, shapes> usable;
+    std::array<board_t, shapes> landable;        // same as binary_bfs
+    std::array<board_t, orientations> rotated;   // landable with a rotation as the last input
+    std::array<board_t, orientations> last_kick; // part of rotated where that rotation used the last kick of its table
+  };
+
+  // binary_bfs plus one more rotation pass over the reachable positions, remembering where rotations land
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  constexpr spin_result<block, board_t> binary_bfs_spin(board_t data) {
+    constexpr int orientations = block.orientations;
+    constexpr int shapes = block.shapes;
+    spin_result<block, board_t> ret;
+    auto &usable = ret.usable;
+    static_for<shapes>([&][[gnu::always_inline]](auto i) {
+      usable[i] = usable_positions<block.minos[i]>(data);
+    });
+    std::array<board_t, orientations> cache;
+    if (!soft_drop_closure<block, start, init_rot>(usable.data(), cache)) [[unlikely]] {
+      return ret;
+    }
+    static_for<orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret.landable[index] |= cache[i];
+    });
+    static_for<shapes>([&][[gnu::always_inline]](auto i){
+      ret.landable[i] &= landable_positions(usable[i]);
+    });
+    static_for<std::tuple_size_v<decltype(block.kicks)>>([&][[gnu::always_inline]](auto j){
+      constexpr auto this_kick = block.kicks[j];
+      constexpr auto diff = this_kick[0_szc];
+      constexpr auto kick_table = this_kick[1_szc];
+      constexpr auto source = index_c<diff[0_szc]>;
+      constexpr auto target = index_c<diff[1_szc]>;
+      constexpr auto index = index_c<block.mino_index[source][0_szc]>;
+      constexpr auto index2 = index_c<block.mino_index[target][0_szc]>;
+      constexpr std::size_t kicks = std::tuple_size_v<decltype(kick_table)>;
+      board_t temp = cache[source];
+      static_for<kicks>([&][[gnu::always_inline]](auto k){
+        const board_t to = move_usable<block.minos[index], block.minos[index2], kick_table[k]>(temp) & usable[index2];
+        ret.rotated[target] |= to;
+        if constexpr (k == kicks - 1) {
+          ret.last_kick[target] |= to;
+        }
+        temp &= ~move_usable<block.minos[index2], block.minos[index], -kick_table[k]>(usable[index2]);
+      });
+    });
+    static_for<orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret.rotated[i] &= ret.landable[index];
+      ret.last_kick[i] &= ret.landable[index];
+    });
+    return ret;
+  }
+
+  // positions that can move neither left, right nor up
+  template <typename board_t>
+  constexpr board_t immobile_positions(board_t usable) {
+    return usable & ~(usable.template move<coord{1, 0}>() | usable.template move<coord{-1, 0}>() | usable.template move<coord{0, -1}>());
+  }
+
+  // spins of any piece in the all-spin sense: the last input was a rotation and the piece is stuck
+  template <block block, typename board_t>
+  constexpr std::array<board_t, block.orientations> all_spins(const spin_result<block, board_t> &spins) {
+    std::array<board_t, block.orientations> ret;
+    static_for<block.orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      ret[i] = spins.rotated[i] & immobile_positions(spins.usable[index]);
+    });
+    return ret;
+  }
+
+  // positions p whose cell p + d is filled or outside the board (walls, floor and ceiling all count)
+  template <coord d, typename board_t>
+  constexpr board_t occupied_at(board_t data) {
+    return ~(~data).template move<-d>();
+  }
+
+  template <typename board_t>
+  struct t_spin_boards {
+    board_t full;
+    board_t mini;
+  };
+
+  // the cell of a T mino which is not opposite to another one, the corners beside it are the front corners
+  template <Wrap<mino_p> auto mino>
+  constexpr coord t_nub() {
+    int nub_x = 0, nub_y = 0, found = 0;
+    static_for<std::tuple_size_v<decltype(mino)>>([&](auto i){
+      constexpr int x = mino[i][0_szc], y = mino[i][1_szc];
+      bool opposite = false;
+      static_for<std::tuple_size_v<decltype(mino)>>([&](auto j){
+        opposite = opposite || (mino[j][0_szc] == -x && mino[j][1_szc] == -y);
+      });
+      if ((x != 0 || y != 0) && !opposite) {
+        nub_x = x;
+        nub_y = y;
+        ++found;
+      }
+    });
+    return found == 1 ? coord{nub_x, nub_y} : coord{0, 0};
+  }
+
+  // guideline T-spin classification with the 3-corner rule:
+  // a rotated landing with at least 3 occupied corners is a T-spin, it is full if both front corners
+  // are occupied or the rotation used the last kick, otherwise it is a mini
+  template <block block, typename board_t>
+  constexpr std::array<t_spin_boards<board_t>, block.orientations>
+  t_spins(board_t data, const spin_result<block, board_t> &spins) {
+    std::array<t_spin_boards<board_t>, block.orientations> ret;
+    static_for<block.orientations>([&][[gnu::always_inline]](auto i){
+      constexpr auto index = block.mino_index[i][0_szc];
+      constexpr coord nub = t_nub<block.minos[index_c<index>]>();
+      constexpr int nx = nub[0_szc], ny = nub[1_szc];
+      static_assert(nx * nx + ny * ny == 1, "t_spins needs a T shaped block centered at (0, 0)");
+      const board_t front1 = occupied_at<coord{nx + ny, ny + nx}>(data);
+      const board_t front2 = occupied_at<coord{nx - ny, ny - nx}>(data);
+      const board_t back1 = occupied_at<coord{-nx + ny, -ny + nx}>(data);
+      const board_t back2 = occupied_at<coord{-nx - ny, -ny - nx}>(data);
+      const board_t three_corners = (front1 & front2 & (back1 | back2)) | (back1 & back2 & (front1 | front2));
+      const board_t spin = spins.rotated[i] & three_corners;
+      ret[i].full = spin & ((front1 & front2) | spins.last_kick[i]);
+      ret[i].mini = spin & ~ret[i].full;
+    });
+    return ret;
+  }
+}
@@ -0,0 +1,241 @@
+#pragma once
+#include "utils.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+// what binary_bfs does on a board: whether the spawn fast path fired, how often the closures looped,
+// how many kicks were tried and the cycles of every phase. off unless REACHABILITY_STATS is 1 where search.hpp
+// is first included; when off every hook is an empty inline function and the search compiles as before
+#ifndef REACHABILITY_STATS
+#define REACHABILITY_STATS 0
+#endif
+#if REACHABILITY_STATS
+#if defined(__x86_64__) || defined(__i386__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace reachability::inline REACHABILITY_ISA::stats {
+  inline constexpr bool enabled = REACHABILITY_STATS;
+
+  enum class phase {
+    usable,  // usable_positions of every shape
+    init,    // spawn_positions, or seeding the window
+    closure, // moves and soft drop
+    kicks,   // rotations
+    landable // merging the orientations and keeping the landable positions
+  };
+  inline constexpr int phases = 5;
+  inline constexpr std::array<std::string_view, phases> phase_names = {"usable", "init", "closure", "kicks", "landable"};
+
+  // one binary_bfs call
+  struct call {
+    bool fast_path; // the spawn row was open, so every line above the stack was seeded at once
+    bool windowed;  // only the lowest words of the board were searched
+    int outer;      // rounds over the orientations, until no rotation reaches a new position
+    int inner;      // iterations of the move closures
+    int kicks;      // kick offsets tried
+    std::array<std::uint64_t, phases> cycles;
+  };
+
+  // counts of values, exact below 64 and in eighths of a power of two above
+  class histogram {
+  public:
+    static constexpr int buckets = 64 + (64 - 6) * 8;
+    void add(std::uint64_t value) {
+      ++counts[bucket(value)];
+    }
+    histogram &operator+=(const histogram &other) {
+      for (int i = 0; i < buckets; ++i) {
+        counts[i] += other.counts[i];
+      }
+      return *this;
+    }
+    std::uint64_t size() const {
+      std::uint64_t ret = 0;
+      for (auto count : counts) {
+        ret += count;
+      }
+      return ret;
+    }
+    // [[lower, upper, count], ...] for every bucket that is not empty, upper excluded
+    void write_json(std::ostream &out) const {
+      out << '[';
+      bool first = true;
+      for (int i = 0; i < buckets; ++i) {
+        if (counts[i]) {
+          out << (first ? "" : ", ") << '[' << lower(i) << ", " << lower(i + 1) << ", " << counts[i] << ']';
+          first = false;
+        }
+      }
+      out << ']';
+    }
+  private:
+    static int bucket(std::uint64_t v) {
+      if (v < 64) {
+        return v;
+      }
+      const int e = std::bit_width(v) - 1;
+      return 64 + (e - 6) * 8 + int(v >> (e - 3)) - 8;
+    }
+    static std::uint64_t lower(int i) {
+      if (i < 64) {
+        return i;
+      }
+      const int e = (i - 64) / 8 + 6;
+      // the bucket past the last one is 2^64, which does not fit
+      return e == 64 ? ~std::uint64_t(0) : std::uint64_t((i - 64) % 8 + 8) << (e - 3);
+    }
+    std::array<std::uint64_t, buckets> counts = {};
+  };
+
+  // every call of one thread added up
+  struct summary {
+    std::uint64_t calls = 0, fast_path = 0, windowed = 0;
+    histogram outer, inner, kicks;
+    std::array<std::uint64_t, phases> total_cycles = {};
+    std::array<histogram, phases> cycles;
+    void add(const call &c) {
+      ++calls;
+      fast_path += c.fast_path;
+      windowed += c.windowed;
+      outer.add(c.outer);
+      inner.add(c.inner);
+      kicks.add(c.kicks);
+      for (int i = 0; i < phases; ++i) {
+        total_cycles[i] += c.cycles[i];
+        cycles[i].add(c.cycles[i]);
+      }
+    }
+    summary &operator+=(const summary &other) {
+      calls += other.calls;
+      fast_path += other.fast_path;
+      windowed += other.windowed;
+      outer += other.outer;
+      inner += other.inner;
+      kicks += other.kicks;
+      for (int i = 0; i < phases; ++i) {
+        total_cycles[i] += other.total_cycles[i];
+        cycles[i] += other.cycles[i];
+      }
+      return *this;
+    }
+    void write_json(std::ostream &out) const {
+      out << "{\"calls\": " << calls << ", \"fast_path\": " << fast_path << ", \"windowed\": " << windowed;
+      out << ", \"outer\": ";
+      outer.write_json(out);
+      out << ", \"inner\": ";
+      inner.write_json(out);
+      out << ", \"kicks\": ";
+      kicks.write_json(out);
+      out << ", \"cycles\": {";
+      for (int i = 0; i < phases; ++i) {
+        out << (i ? ", " : "") << '"' << phase_names[i] << "\": {\"total\": " << total_cycles[i] << ", \"histogram\": ";
+        cycles[i].write_json(out);
+        out << '}';
+      }
+      out << "}}";
+    }
+  };
+
+  namespace details {
+    struct thread_state {
+      call current = {}, last = {};
+      summary total;
+      int depth = 0;
+    };
+    constinit inline thread_local thread_state state;
+    inline std::uint64_t ticks() {
+#if REACHABILITY_STATS
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+#else
+      return 0;
+#endif
+    }
+  }
+
+  // the last call that finished on this thread and the totals of this thread since the last reset
+  inline const call &last() {
+    return details::state.last;
+  }
+  inline const summary &collected() {
+    return details::state.total;
+  }
+  inline void reset() {
+    details::state.total = {};
+  }
+
+  namespace details {
+    class call_scope {
+    public:
+      constexpr call_scope() {
+        if (!std::is_constant_evaluated() && state.depth++ == 0) {
+          state.current = {};
+        }
+      }
+      call_scope(const call_scope &) = delete;
+      call_scope &operator=(const call_scope &) = delete;
+      constexpr ~call_scope() {
+        if (!std::is_constant_evaluated() && --state.depth == 0) {
+          state.last = state.current;
+          state.total.add(state.current);
+        }
+      }
+    };
+    template <phase p>
+    class timer {
+    public:
+      constexpr timer() {
+        if (!std::is_constant_evaluated()) {
+          start = ticks();
+        }
+      }
+      timer(const timer &) = delete;
+      timer &operator=(const timer &) = delete;
+      constexpr ~timer() {
+        if (!std::is_constant_evaluated()) {
+          state.current.cycles[int(p)] += ticks() - start;
+        }
+      }
+    private:
+      std::uint64_t start = 0;
+    };
+    // what the hooks are when off: trivial, so they leave no cleanup behind for the inliner to weigh
+    struct [[maybe_unused]] nothing {};
+  }
+
+  // the hooks of search.hpp; scopes nest, a call is the outermost one
+  using call_scope = std::conditional_t<enabled, details::call_scope, details::nothing>;
+  template <phase p>
+  using timer = std::conditional_t<enabled, details::timer<p>, details::nothing>;
+  template <int call::*field>
+  constexpr void count(int n = 1) {
+    if constexpr (enabled) {
+      if (!std::is_constant_evaluated()) {
+        details::state.current.*field += n;
+      }
+    }
+  }
+  template <bool call::*field>
+  constexpr void mark() {
+    if constexpr (enabled) {
+      if (!std::is_constant_evaluated()) {
+        details::state.current.*field = true;
+      }
+    }
+  }
+}
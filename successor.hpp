@@ -0,0 +1,55 @@
+#pragma once
+#include "block.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "utils.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace reachability::inline REACHABILITY_ISA::search {
+  template <typename board_t>
+  struct successor {
+    board_t board; // after lock and line clear
+    std::uint8_t shape;
+    std::int8_t x, y;
+    std::uint8_t lines;
+  };
+
+  // lock mino on data at every bit of landable, writing the results from out[0]; out must hold landable.count() entries
+  template <Wrap<mino_p> auto mino, typename board_t>
+  std::size_t lock_all(board_t data, board_t landable, std::uint8_t shape, successor<board_t> *out) {
+    std::size_t n = 0;
+    for_each_lock<mino>(data, landable, [&][[gnu::always_inline]](int x, int y, const clear_result<board_t> &result) {
+      out[n++] = {result.board, shape, std::int8_t(x), std::int8_t(y), std::uint8_t(result.lines)};
+    });
+    return n;
+  }
+
+  // every placement of block reachable from start, with the board after lock and line clear
+  // returns the number of successors; if that exceeds out.size(), nothing is written
+  template <block block, coord start, std::size_t init_rot, typename board_t>
+  std::size_t generate_successors(board_t data, std::span<successor<board_t>> out) {
+    const auto landable = binary_bfs<block, start, init_rot>(data);
+    std::size_t total = 0;
+    static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+      total += landable[i].count();
+    });
+    if (total > out.size()) [[unlikely]] {
+      return total;
+    }
+    std::size_t n = 0;
+    static_for<block.shapes>([&][[gnu::always_inline]](auto i) {
+      n += lock_all<block.minos[i]>(data, landable[i], i, out.data() + n);
+    });
+    return n;
+  }
+  template <typename RS, coord start, unsigned init_rot=0, typename board_t>
+  [[gnu::noinline]]
+  std::size_t generate_successors(board_t data, block_type b, std::span<successor<board_t>> out) {
+    return call_with_block<RS>(b, [=]<block B>() {
+      return generate_successors<B, start, init_rot % B.orientations>(data, out);
+    });
+  }
+}
@@ -3,7 +3,14 @@
 #include <utility>
 #include <span>
 #include <algorithm>
-namespace reachability {
+
+// the library lives in an inline namespace named after the instruction set it is compiled for, so copies built with
+// different -march flags can be linked into one binary without their inline functions merging (see dispatch.hpp)
+#ifndef REACHABILITY_ISA
+#define REACHABILITY_ISA native
+#endif
+
+namespace reachability::inline REACHABILITY_ISA {
   template<typename F, std::size_t... S>
   [[gnu::always_inline]]
   constexpr void static_for(F&& function, std::index_sequence<S...>) {
@@ -30,6 +37,9 @@ namespace reachability {
       static_assert(M <= N);
       std::copy(arr.begin(), arr.end(), data);
     }
+    constexpr static_vector(std::span<T> arr): used(arr.size()) {
+      std::copy(arr.begin(), arr.end(), data);
+    }
     static_vector() = delete;
     constexpr std::size_t size() const {
       return used;
@@ -75,7 +85,7 @@ namespace std {
   template <std::size_t I, typename T> constexpr T& get(::reachability::details::tuple_leaf<I, T>& t) { return t.data; }
 }
 
-namespace reachability {
+namespace reachability::inline REACHABILITY_ISA {
   namespace details {
     template <typename Seq, typename...> struct tuple_impl;
 
@@ -127,7 +137,7 @@ namespace std {
   template <class... Ts> struct tuple_size<::reachability::tuple<Ts...>>: std::integral_constant<std::size_t, sizeof...(Ts)> { };
 }
 
-namespace reachability {
+namespace reachability::inline REACHABILITY_ISA {
   // concept written as tempate arg -> template arg -> bool
   // because we cannot pass concepts as template parameters yet (p2841)
   // __cpp_template_parameters >= 202502L